@@ -45,9 +45,14 @@ ReverbLabFX::ReverbLabFX()
     : m_pParams(nullptr)
     , m_pAllocator(nullptr)
     , m_pContext(nullptr)
+    , m_pSharedEngine(nullptr)
+    , m_bSharedOwner(false)
+    , m_bDetached(false)
+    , m_uParamMismatchFrames(0)
+    , m_uMaxFrames(0)
 {
     // Reverb constructor
-    reverb = std::make_unique<BasicReverb<CHANNELS, DIFFUSER_STEPS>>(ROOM_SIZE, 2.0);
+    reverb = std::make_unique<ReverbLabReverb>(ROOM_SIZE, 2.0);
 }
 
 ReverbLabFX::~ReverbLabFX()
@@ -65,23 +70,171 @@ AKRESULT ReverbLabFX::Init(AK::IAkPluginMemAlloc* in_pAllocator, AK::IAkEffectPl
     spec.sampleRate = in_rFormat.uSampleRate;
     spec.numChannels = 1;
 
+    // Everything pending is applied here, so the first Execute() doesn't redo it
+    ReverbLabParamSnapshot params;
+    m_pParams->AcquireSnapshot(params);
+
     // Init using ProcessSpec
     outputGain.prepare(spec);
-    outputGain.setGainDecibels(0.f);
     outputGain.setRampDurationSeconds(0.2f);
-    reverb->configure(spec);
+    outputGain.setGainDecibels(params.RTPC.fOutputGain);
+
+    m_governor.Init(ReverbLabReverb::qualityTiers - 1);
+    m_governor.SetBudget(params.NonRTPC.fCPUBudget, params.NonRTPC.uBudgetScope == BUDGET_SCOPE_GLOBAL);
+
+    // Our own reverb is always set up here, so falling back to it later never allocates in Execute()
+    ConfigureReverb(*reverb, params);
+
+    // With coalescing, run on the engine shared by instances with the same structure instead of our own
+    m_uMaxFrames = in_pContext->GlobalContext()->GetMaxBufferLength();
+    if (params.NonRTPC.bCoalesce)
+    {
+        JoinSharedEngine(params);
+    }
+    m_governor.SetMaxTier(ActiveReverb().maxQualityTier());
+    m_governor.StartAtTier(ActiveReverb().qualityTier);
 
     return AK_Success;
 }
 
+void ReverbLabFX::ConfigureReverb(ReverbLabReverb& io_rReverb, const ReverbLabParamSnapshot& in_rParams)
+{
+    // Derived DSP state: use what the authoring tool baked for this sample rate,
+    // or compute the same data now if the bank doesn't have it
+    ReverbLabBakedData computedData;
+    const ReverbLabBakedData* pDerived = m_pParams->GetBakedData((AkUInt32)spec.sampleRate);
+    if (!pDerived)
+    {
+        ReverbLabComputeBakedData(in_rParams.RTPC.fRT, in_rParams.RTPC.fHFCutoff, in_rParams.RTPC.fHFAttenuation,
+            in_rParams.NonRTPC.fCPUBudget, (AkUInt32)spec.sampleRate, computedData);
+        pDerived = &computedData;
+    }
+
+    io_rReverb.configure(spec, pDerived->feedbackDelays, pDerived->diffusionDelays, pDerived->polarityMasks,
+        pDerived->velvetDelays, pDerived->velvetSignMasks);
+    io_rReverb.setVelvetDiffuser(in_rParams.NonRTPC.uDiffuserType == DIFFUSER_VELVET);
+
+    // Baked gain and coefficients only hold for the values they were baked from
+    if (pDerived->fRT == in_rParams.RTPC.fRT)
+        io_rReverb.setDecayGain(in_rParams.RTPC.fRT, pDerived->fDecayGain);
+    else
+        io_rReverb.setRt60(in_rParams.RTPC.fRT);
+    if (pDerived->fHFCutoff == in_rParams.RTPC.fHFCutoff && pDerived->fHFAttenuation == in_rParams.RTPC.fHFAttenuation)
+        io_rReverb.setDampingCoefficients(pDerived->shelfCoefficients, pDerived->bEnableDamping);
+    else
+        io_rReverb.setDamping(in_rParams.RTPC.fHFCutoff, in_rParams.RTPC.fHFAttenuation);
+
+    io_rReverb.setQualityTier(in_rParams.NonRTPC.fCPUBudget > 0.f ? pDerived->uQualityTier : 0);
+}
+
+void ReverbLabFX::JoinSharedEngine(const ReverbLabParamSnapshot& in_rParams)
+{
+    const ReverbLabSharedEngine::Key key = ReverbLabSharedEngine::Key::FromParams(in_rParams, (AkUInt32)spec.sampleRate, m_pContext->GetNodeID());
+    m_pSharedEngine = ReverbLabSharedEngine::Join(key, m_uMaxFrames);
+    m_bSharedOwner = false;
+
+    // First instance in sets the engine up, before any other instance can join and render it
+    if (!m_pSharedEngine)
+    {
+        ReverbLabSharedEngine* pEngine = ReverbLabSharedEngine::Create(m_pAllocator, key, in_rParams.RTPC, m_uMaxFrames);
+        if (pEngine)
+        {
+            ConfigureReverb(pEngine->Reverb(), in_rParams);
+            m_pSharedEngine = ReverbLabSharedEngine::Publish(m_pAllocator, pEngine);
+        }
+    }
+
+    // An engine someone else already runs with other wet parameters: start on our own reverb
+    m_bDetached = false;
+    m_uParamMismatchFrames = (m_pSharedEngine && !m_pSharedEngine->Matches(in_rParams.RTPC)) ? PARAM_MISMATCH_FRAMES : 0;
+}
+
+void ReverbLabFX::RestartOwnReverb(const ReverbLabParamSnapshot& in_rParams)
+{
+    // Our own reverb sat idle while on the shared engine: start it from silence with the current parameters
+    reverb->reset();
+    reverb->setRt60(in_rParams.RTPC.fRT);
+    reverb->setDamping(in_rParams.RTPC.fHFCutoff, in_rParams.RTPC.fHFAttenuation);
+    reverb->setVelvetDiffuser(in_rParams.NonRTPC.uDiffuserType == DIFFUSER_VELVET);
+    reverb->setQualityTier(m_governor.GetTier());
+}
+
+void ReverbLabFX::UpdateSharedEngine(const ReverbLabParamSnapshot& in_rParams)
+{
+    const bool bWasAttached = m_pSharedEngine && !m_bDetached;
+    ReverbLabSharedEngine* pEngine = nullptr;
+    if (in_rParams.NonRTPC.bCoalesce)
+    {
+        const ReverbLabSharedEngine::Key key = ReverbLabSharedEngine::Key::FromParams(in_rParams, (AkUInt32)spec.sampleRate, m_pContext->GetNodeID());
+        if (m_pSharedEngine && m_pSharedEngine->GetKey() == key)
+            return;
+
+        // Only join an engine another instance already runs: creating one would allocate here
+        pEngine = m_pSharedEngine
+            ? ReverbLabSharedEngine::Move(m_pAllocator, m_pSharedEngine, key, m_uMaxFrames, this)
+            : ReverbLabSharedEngine::Join(key, m_uMaxFrames);
+
+        // Still on our own reverb, which Execute() keeps up to date
+        if (!m_pSharedEngine && !pEngine)
+            return;
+    }
+    else if (m_pSharedEngine)
+    {
+        ReverbLabSharedEngine::Release(m_pAllocator, m_pSharedEngine, this);
+    }
+    else
+    {
+        return;
+    }
+
+    if (pEngine != m_pSharedEngine)
+    {
+        m_pSharedEngine = pEngine;
+        m_bSharedOwner = false;
+    }
+
+    m_governor.SetBudget(in_rParams.NonRTPC.fCPUBudget, in_rParams.NonRTPC.uBudgetScope == BUDGET_SCOPE_GLOBAL);
+    if (m_pSharedEngine)
+    {
+        m_uParamMismatchFrames = m_pSharedEngine->Matches(in_rParams.RTPC) ? 0 : PARAM_MISMATCH_FRAMES;
+    }
+    else
+    {
+        // Already running on our own reverb if the parameters differed from the engine's
+        if (bWasAttached)
+        {
+            RestartOwnReverb(in_rParams);
+        }
+        m_bDetached = false;
+    }
+    m_governor.SetMaxTier(ActiveReverb().maxQualityTier());
+    m_governor.StartAtTier(ActiveReverb().qualityTier);
+}
+
 AKRESULT ReverbLabFX::Term(AK::IAkPluginMemAlloc* in_pAllocator)
 {
+    if (m_pSharedEngine)
+    {
+        ReverbLabSharedEngine::Release(in_pAllocator, m_pSharedEngine, this);
+        m_pSharedEngine = nullptr;
+    }
     AK_PLUGIN_DELETE(in_pAllocator, this);
     return AK_Success;
 }
 
 AKRESULT ReverbLabFX::Reset()
 {
+    // Drop the old tail so it isn't replayed after bypass. This is O(1): the delay lines
+    // treat everything written before the reset as silence instead of clearing their memory.
+    // A shared engine's tail belongs to the other instances as well, so it is left alone,
+    // but another instance renders it from now on.
+    if (m_pSharedEngine)
+    {
+        m_pSharedEngine->ReleaseOwnership(this);
+        m_bSharedOwner = false;
+    }
+    reverb->reset();
+    outputGain.reset();
     return AK_Success;
 }
 
@@ -96,10 +249,84 @@ AKRESULT ReverbLabFX::GetPluginInfo(AkPluginInfo& out_rPluginInfo)
 
 void ReverbLabFX::Execute(AkAudioBuffer* io_pBuffer)
 {
+    // Take one consistent copy of the parameters for the whole block
+    ReverbLabParamSnapshot params;
+    m_pParams->AcquireSnapshot(params);
+
+    // Coalescing was toggled, or a structural parameter the shared engine is keyed on changed: move to the
+    // matching engine. Without one yet, keep looking, e.g. for the engine the last instance took along.
+    if (params.HasChanged(PARAM_COALESCE_ID) ||
+        (m_pSharedEngine && (params.uChangeMask & ReverbLabSharedEngine::KEY_PARAMS_MASK)) ||
+        (!m_pSharedEngine && params.NonRTPC.bCoalesce))
+    {
+        UpdateSharedEngine(params);
+    }
+
+    // Same for output gain
+    if (params.HasChanged(PARAM_OUTPUTGAIN))
+    {
+        outputGain.setGainDecibels(params.RTPC.fOutputGain);
+    }
+
+    // The shared engine follows its owner's parameters in BeginSharedFrame(); here only our own reverb is updated
+    if (!m_pSharedEngine || m_bDetached)
+    {
+        // If Decay Time has changed，reinvoke related setup function
+        if (params.HasChanged(PARAM_RT_ID))
+        {
+            reverb->setRt60(params.RTPC.fRT);
+        }
+        // If Damping parameters changed, recalculate coefficients and update HS filter
+        if (params.HasChanged(PARAM_HFCUTOFF_ID) ||
+            params.HasChanged(PARAM_HFATTENUATION_ID))
+        {
+            reverb->setDamping(params.RTPC.fHFCutoff, params.RTPC.fHFAttenuation);
+        }
+        // Both diffusers are set up in Init, so switching doesn't allocate
+        if (params.HasChanged(PARAM_DIFFUSERTYPE_ID))
+        {
+            reverb->setVelvetDiffuser(params.NonRTPC.uDiffuserType == DIFFUSER_VELVET);
+            // Tiers past damping off save nothing on the velvet diffuser
+            m_governor.SetMaxTier(reverb->maxQualityTier());
+        }
+        // A new CPU budget or scope restarts the governor's measurements; disabling it restores full quality
+        if (params.HasChanged(PARAM_CPUBUDGET_ID) || params.HasChanged(PARAM_BUDGETSCOPE_ID))
+        {
+            m_governor.SetBudget(params.NonRTPC.fCPUBudget, params.NonRTPC.uBudgetScope == BUDGET_SCOPE_GLOBAL);
+            reverb->setQualityTier(m_governor.GetTier());
+        }
+    }
+    // The budget is part of the shared engine's key, the scope isn't
+    else if (params.HasChanged(PARAM_BUDGETSCOPE_ID))
+    {
+        m_governor.SetBudget(params.NonRTPC.fCPUBudget, params.NonRTPC.uBudgetScope == BUDGET_SCOPE_GLOBAL);
+    }
+
     // Configure tail handler based on reverb length after input cutoff
-    AkUInt32 totalTailFrames = spec.sampleRate * m_pParams->RTPC.fRT;
+    AkUInt32 totalTailFrames = spec.sampleRate * params.RTPC.fRT;
     m_FXTailHandler.HandleTail(io_pBuffer, totalTailFrames);
 
+    // Block constants: calculate dry wet mix and stereo width once
+    const AkReal32 dryMix = 1.0f - params.RTPC.fDryWetMix / 100.f;
+    const AkReal32 wetMix = params.RTPC.fDryWetMix / 100.f;
+    const AkReal32 stereoWidth = params.RTPC.fStereoWidth;
+
+    m_governor.BeginBlock();
+
+    // Shared engine: only the owner renders and picks the engine's tier. With a global budget the
+    // other instances' cost still counts towards the total. With other wet parameters than the
+    // engine's, this block runs on our own reverb below.
+    bool bOwner = false;
+    if (m_pSharedEngine && BeginSharedFrame(params, bOwner))
+    {
+        ExecuteShared(io_pBuffer, bOwner, dryMix, wetMix);
+        if (bOwner || m_governor.IsGlobal())
+        {
+            UpdateQualityTier(io_pBuffer->uValidFrames, bOwner);
+        }
+        return;
+    }
+
     const AkUInt32 uNumChannels = io_pBuffer->NumChannels();    // input channels (default: 2)
     AkUInt16 uFramesProcessed = 0;                              // current sample index
     while (uFramesProcessed < io_pBuffer->uValidFrames)
@@ -118,23 +345,6 @@ void ReverbLabFX::Execute(AkAudioBuffer* io_pBuffer)
         }
         multiChannelMixer.stereoToMulti(stereoInput, multiChannelInput);
 
-        // If Decay Time has changed，reinvoke related setup function
-        if (m_pParams->m_paramChangeHandler.HasChanged(PARAM_RT_ID))
-        {
-            reverb->setRt60(m_pParams->RTPC.fRT);
-        }
-        // If Damping parameters changed, recalculate coefficients and update HS filter
-        if (m_pParams->m_paramChangeHandler.HasChanged(PARAM_HFCUTOFF_ID)|| 
-            m_pParams->m_paramChangeHandler.HasChanged(PARAM_HFATTENUATION_ID))
-        {
-            reverb->setDamping(m_pParams->RTPC.fHFCutoff, m_pParams->RTPC.fHFAttenuation);
-        }
-        // Same for output gain
-        if (m_pParams->m_paramChangeHandler.HasChanged(PARAM_OUTPUTGAIN))
-        {
-            outputGain.setGainDecibels(m_pParams->RTPC.fOutputGain);
-        }
-
         // Call reverb algorithm (see revalg.h). Downmix back to stereo after processing.
         multiChannelOutput = reverb->process(multiChannelInput);
         multiChannelMixer.multiToStereo(multiChannelOutput, stereoOutput);
@@ -145,16 +355,12 @@ void ReverbLabFX::Execute(AkAudioBuffer* io_pBuffer)
 
         // Transfer L-R signal to M-S encoding for stereo expanding or narrowing
         AkReal32 revM = (revL + revR)*0.5;
-        AkReal32 revS = (revL - revR)*0.5* m_pParams->RTPC.fStereoWidth;
+        AkReal32 revS = (revL - revR)*0.5* stereoWidth;
         
         // Get data store in left-right channel buffer
         AkReal32* AK_RESTRICT pBufL = (AkReal32 * AK_RESTRICT)io_pBuffer->GetChannel(0);
         AkReal32* AK_RESTRICT pBufR = (AkReal32 * AK_RESTRICT)io_pBuffer->GetChannel(1);
 
-        // Calculate dry wet mix
-        AkReal32 dryMix = 1.0f - m_pParams->RTPC.fDryWetMix / 100.f;
-        AkReal32 wetMix = m_pParams->RTPC.fDryWetMix / 100.f;
-
         // Transfer M-S back to L-R and apply output gain
         pBufL[uFramesProcessed] = outputGain.processSample(pBufL[uFramesProcessed] * dryMix + (revM - revS)* wetMix);
         pBufR[uFramesProcessed] = outputGain.processSample(pBufR[uFramesProcessed] * dryMix + (revM + revS) * wetMix);
@@ -169,10 +375,84 @@ void ReverbLabFX::Execute(AkAudioBuffer* io_pBuffer)
         }
 
     }
+
+    UpdateQualityTier(io_pBuffer->uValidFrames, true);
    
 }
 
+bool ReverbLabFX::BeginSharedFrame(const ReverbLabParamSnapshot& in_rParams, bool& out_bOwner)
+{
+    // Input added during this frame is rendered during the next one, whichever instance renders it
+    out_bOwner = m_pSharedEngine->BeginFrame(this, m_pContext->GlobalContext()->GetBufferTick());
+    if (out_bOwner)
+    {
+        // Just took over: continue from the quality the engine runs at
+        if (!m_bSharedOwner)
+        {
+            m_governor.StartAtTier(m_pSharedEngine->Reverb().qualityTier);
+        }
+        m_pSharedEngine->FollowParams(in_rParams.RTPC);
+    }
+    m_bSharedOwner = out_bOwner;
+
+    // Leave the engine's input alone while our wet parameters differ from its own. A difference seen
+    // for one frame only may just be the owner not having executed yet with the same new values.
+    if (m_pSharedEngine->Matches(in_rParams.RTPC))
+        m_uParamMismatchFrames = 0;
+    else if (m_uParamMismatchFrames < PARAM_MISMATCH_FRAMES)
+        ++m_uParamMismatchFrames;
+
+    const bool bDetach = m_uParamMismatchFrames >= PARAM_MISMATCH_FRAMES;
+    if (bDetach && !m_bDetached)
+    {
+        RestartOwnReverb(in_rParams);
+    }
+    m_bDetached = bDetach;
+    return !bDetach;
+}
+
+void ReverbLabFX::ExecuteShared(AkAudioBuffer* io_pBuffer, bool in_bOwner, AkReal32 in_fDryMix, AkReal32 in_fWetMix)
+{
+    const AkUInt32 uFrames = io_pBuffer->uValidFrames;
+    AkReal32* AK_RESTRICT pBufL = (AkReal32 * AK_RESTRICT)io_pBuffer->GetChannel(0);
+    AkReal32* AK_RESTRICT pBufR = (AkReal32 * AK_RESTRICT)io_pBuffer->GetChannel(1);
+
+    // The network is linear, so wet mix and output gain can be applied to our share of its input
+    m_pSharedEngine->Accumulate(pBufL, pBufR, uFrames, in_fWetMix * outputGain.getGainLinear());
+
+    for (AkUInt32 i = 0; i < uFrames; ++i)
+    {
+        pBufL[i] = outputGain.processSample(pBufL[i] * in_fDryMix);
+        pBufR[i] = outputGain.processSample(pBufR[i] * in_fDryMix);
+    }
+
+    // The owner outputs the wet signal of every instance on the engine
+    if (in_bOwner)
+    {
+        m_pSharedEngine->RenderAdd(pBufL, pBufR, uFrames);
+    }
+}
+
+void ReverbLabFX::UpdateQualityTier(AkUInt32 in_uFrames, bool in_bApply)
+{
+    // Degrade or restore quality for the next blocks depending on how this one did against the budget
+    if (m_governor.IsEnabled())
+    {
+        AkUInt32 uTier = m_governor.EndBlock(in_uFrames, spec.sampleRate, m_pContext->GlobalContext()->GetBufferTick());
+        if (in_bApply && (int)uTier != ActiveReverb().qualityTier)
+        {
+            ActiveReverb().setQualityTier(uTier);
+        }
+    }
+}
+
 AKRESULT ReverbLabFX::TimeSkip(AkUInt32 in_uFrames)
 {
+    // Virtual: let an instance that still executes render the shared engine
+    if (m_pSharedEngine)
+    {
+        m_pSharedEngine->ReleaseOwnership(this);
+        m_bSharedOwner = false;
+    }
     return AK_DataReady;
 }
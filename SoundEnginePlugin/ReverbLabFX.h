@@ -28,18 +28,17 @@ the specific language governing permissions and limitations under the License.
 #define ReverbLabFX_H
 
 #include "ReverbLabFXParams.h"
+#include "ReverbLabFXGovernor.h"
+#include "ReverbLabFXCoalescer.h"
+#include "ReverbLabFXReverb.h"
 #include "external/delay.h"
 
-#include "external/revalg.h"
 #include "external/mix.h"
 
 #include <AK/Plugin/PluginServices/AkFXTailHandler.h>
 #include <memory> 
 
-// Delayline setup. These static parameters should be defined before compiling
-#define CHANNELS 8
-#define DIFFUSER_STEPS 5
-#define ROOM_SIZE 48.f
+// Delayline setup (CHANNELS, DIFFUSER_STEPS, ROOM_SIZE) lives in ReverbLabFXBakedData.h
 // Calibrate reverb gain based on matrix channels
 #define GAIN_CALIBR (4.0 / CHANNELS) 
 
@@ -82,15 +81,51 @@ private:
     juce::dsp::ProcessSpec spec;
     AkFXTailHandler	m_FXTailHandler;
     ReverbLabFXParams* m_pParams;
+    ReverbLabFXGovernor m_governor;
 
     // SDK Plugin Interface
     AK::IAkPluginMemAlloc* m_pAllocator;
     AK::IAkEffectPluginContext* m_pContext;
 
+    /// Set up a reverb network for the parameters, from baked data when the bank has it.
+    void ConfigureReverb(ReverbLabReverb& io_rReverb, const ReverbLabParamSnapshot& in_rParams);
+
+    /// Coalescing: join the shared engine matching the structural parameters, or switch back to our own reverb.
+    /// Only Init() may create an engine; UpdateSharedEngine() joins existing ones, takes its own along
+    /// to a new key when alone on it, or falls back. It leaves the engine alone while the key is unchanged.
+    void JoinSharedEngine(const ReverbLabParamSnapshot& in_rParams);
+    void UpdateSharedEngine(const ReverbLabParamSnapshot& in_rParams);
+
+    /// Start this frame on the shared engine. Returns false while our wet parameters differ from
+    /// the engine's, in which case the block runs on our own reverb.
+    bool BeginSharedFrame(const ReverbLabParamSnapshot& in_rParams, bool& out_bOwner);
+
+    /// Execute() on a shared engine; in_bOwner from BeginSharedFrame().
+    void ExecuteShared(AkAudioBuffer* io_pBuffer, bool in_bOwner, AkReal32 in_fDryMix, AkReal32 in_fWetMix);
+
+    /// Start our own reverb from silence with the current parameters.
+    void RestartOwnReverb(const ReverbLabParamSnapshot& in_rParams);
+
+    /// Feed this block's cost to the governor and, if in_bApply, apply the tier it picks.
+    void UpdateQualityTier(AkUInt32 in_uFrames, bool in_bApply);
+
+    ReverbLabReverb& ActiveReverb() { return (m_pSharedEngine && !m_bDetached) ? m_pSharedEngine->Reverb() : *reverb; }
+
     //DSP Classes
     juce::dsp::Gain<AkReal32> outputGain;
     signalsmith::mix::StereoMultiMixer<AkReal32, CHANNELS> multiChannelMixer;
-    std::unique_ptr<BasicReverb<CHANNELS, DIFFUSER_STEPS>> reverb;
+    std::unique_ptr<ReverbLabReverb> reverb;
+
+    // Coalescing
+    ReverbLabSharedEngine* m_pSharedEngine;
+    bool m_bSharedOwner;
+    bool m_bDetached;                   // Joined, but rendering on our own reverb for other wet parameters
+    AkUInt32 m_uParamMismatchFrames;    // Consecutive frames our wet parameters differed from the engine's
+    AkUInt32 m_uMaxFrames;
+
+    /// Frames of differing parameters before detaching: in the frame both change, an instance
+    /// executing before the owner still sees the owner's previous values.
+    static constexpr AkUInt32 PARAM_MISMATCH_FRAMES = 2;
 };
 
 #endif // ReverbLabFX_H
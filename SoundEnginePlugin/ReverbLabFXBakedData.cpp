@@ -0,0 +1,151 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2023 Audiokinetic Inc.
+*******************************************************************************/
+
+#include "ReverbLabFXBakedData.h"
+
+#include <cmath>
+
+// Budgets this tight start degraded, so the first blocks of a voice don't overshoot
+// while the governor is still measuring
+static const AkReal32 TIGHT_BUDGET_PERCENT = 1.f;
+static const AkReal32 LOW_BUDGET_PERCENT = 2.5f;
+
+// Small fixed-seed generator, so every build and every device gets the same layout
+static AkReal32 NextRandom(AkUInt32& io_uState)
+{
+    io_uState = io_uState * 1664525u + 1013904223u;
+    return (io_uState >> 8) * (1.f / 16777216.f);
+}
+
+static void ComputeDelayLayout(AkUInt32 in_uSampleRate, ReverbLabBakedData& out_rData)
+{
+    AkUInt32 uRandomState = 1;
+
+    // Feedback: distribute delay times exponentially between ROOM_SIZE and 2*ROOM_SIZE
+    AkReal32 fDelaySamplesBase = ROOM_SIZE * 0.001f * in_uSampleRate;
+    for (int c = 0; c < CHANNELS; ++c)
+    {
+        AkReal32 r = c * 1.f / CHANNELS;
+        out_rData.feedbackDelays[c] = (AkInt32)(std::pow(2.f, r) * fDelaySamplesBase);
+    }
+
+    // Diffusion: halve the range every step, one random delay per channel within its slice of the range
+    AkReal32 fDiffusionMs = ROOM_SIZE;
+    for (int s = 0; s < DIFFUSER_STEPS; ++s)
+    {
+        fDiffusionMs *= 0.5f;
+        AkReal32 fDelaySamplesRange = fDiffusionMs * 0.001f * in_uSampleRate;
+        out_rData.polarityMasks[s] = 0;
+        for (int c = 0; c < CHANNELS; ++c)
+        {
+            AkReal32 fRangeLow = fDelaySamplesRange * c / CHANNELS;
+            AkReal32 fRangeHigh = fDelaySamplesRange * (c + 1) / CHANNELS;
+            out_rData.diffusionDelays[s][c] = (AkInt32)(fRangeLow + NextRandom(uRandomState) * (fRangeHigh - fRangeLow));
+            if (NextRandom(uRandomState) < 0.5f)
+                out_rData.polarityMasks[s] |= 1u << c;
+        }
+    }
+}
+
+static void ComputeVelvetLayout(AkUInt32 in_uSampleRate, ReverbLabBakedData& out_rData)
+{
+    AkUInt32 uRandomState = 2;
+
+    // Halve the span every stage, one tap at a random spot in each slice of the span
+    AkReal32 fStageMs = ROOM_SIZE;
+    for (int s = 0; s < VELVET_STAGES; ++s)
+    {
+        fStageMs *= 0.5f;
+        AkReal32 fSegmentSamples = fStageMs * 0.001f * in_uSampleRate / VELVET_TAPS;
+        for (int c = 0; c < CHANNELS; ++c)
+        {
+            out_rData.velvetSignMasks[s][c] = 0;
+            for (int k = 0; k < VELVET_TAPS; ++k)
+            {
+                out_rData.velvetDelays[s][c][k] = (AkInt32)(fSegmentSamples * (k + NextRandom(uRandomState)));
+                if (NextRandom(uRandomState) < 0.5f)
+                    out_rData.velvetSignMasks[s][c] |= 1u << k;
+            }
+        }
+    }
+}
+
+static void ComputeDecayGain(AkReal32 in_fRT, ReverbLabBakedData& io_rData)
+{
+    // Same as BasicReverb::updateDecayGain
+    AkReal32 fTypicalLoopMs = ROOM_SIZE * 1.5f;
+    AkReal32 fLoopsPerRt60 = in_fRT / (fTypicalLoopMs * 0.001f);
+    AkReal32 fDbPerCycle = -45.f / fLoopsPerRt60;
+
+    io_rData.fRT = in_fRT;
+    io_rData.fDecayGain = std::pow(10.f, fDbPerCycle * 0.05f);
+}
+
+static void ComputeDamping(AkReal32 in_fHFCutoff, AkReal32 in_fHFAttenuation, AkUInt32 in_uSampleRate, ReverbLabBakedData& io_rData)
+{
+    // Same high shelf as juce::dsp::IIR::Coefficients::makeHighShelf with Q = 0.5
+    const AkReal32 fQ = 0.5f;
+    const AkReal32 fGainFactor = std::pow(10.f, -in_fHFAttenuation * 0.05f);
+    const AkReal32 A = std::sqrt(fGainFactor > 0.f ? fGainFactor : 0.f);
+    const AkReal32 fAMinus1 = A - 1.f;
+    const AkReal32 fAPlus1 = A + 1.f;
+    const AkReal32 fOmega = (2.f * 3.14159265358979f * (in_fHFCutoff > 2.f ? in_fHFCutoff : 2.f)) / (AkReal32)in_uSampleRate;
+    const AkReal32 fCos = std::cos(fOmega);
+    const AkReal32 fBeta = std::sin(fOmega) * std::sqrt(A) / fQ;
+    const AkReal32 fAMinus1TimesCos = fAMinus1 * fCos;
+
+    const AkReal32 b0 = A * (fAPlus1 + fAMinus1TimesCos + fBeta);
+    const AkReal32 b1 = A * -2.f * (fAMinus1 + fAPlus1 * fCos);
+    const AkReal32 b2 = A * (fAPlus1 + fAMinus1TimesCos - fBeta);
+    const AkReal32 a0 = fAPlus1 - fAMinus1TimesCos + fBeta;
+    const AkReal32 a1 = 2.f * (fAMinus1 - fAPlus1 * fCos);
+    const AkReal32 a2 = fAPlus1 - fAMinus1TimesCos - fBeta;
+
+    io_rData.fHFCutoff = in_fHFCutoff;
+    io_rData.fHFAttenuation = in_fHFAttenuation;
+    io_rData.shelfCoefficients = { b0 / a0, b1 / a0, b2 / a0, a1 / a0, a2 / a0 };
+    // Same threshold as BasicReverb::setDamping
+    io_rData.bEnableDamping = in_fHFCutoff <= 14999.f;
+}
+
+void ReverbLabComputeBakedData(AkReal32 in_fRT, AkReal32 in_fHFCutoff, AkReal32 in_fHFAttenuation, AkReal32 in_fCPUBudget,
+    AkUInt32 in_uSampleRate, ReverbLabBakedData& out_rData)
+{
+    out_rData.uSampleRate = in_uSampleRate;
+    ComputeDelayLayout(in_uSampleRate, out_rData);
+    ComputeVelvetLayout(in_uSampleRate, out_rData);
+    ComputeDecayGain(in_fRT, out_rData);
+    ComputeDamping(in_fHFCutoff, in_fHFAttenuation, in_uSampleRate, out_rData);
+
+    if (in_fCPUBudget <= 0.f)
+        out_rData.uQualityTier = 0;
+    else if (in_fCPUBudget < TIGHT_BUDGET_PERCENT)
+        out_rData.uQualityTier = 2;
+    else if (in_fCPUBudget < LOW_BUDGET_PERCENT)
+        out_rData.uQualityTier = 1;
+    else
+        out_rData.uQualityTier = 0;
+}
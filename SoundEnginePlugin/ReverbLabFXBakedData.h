@@ -0,0 +1,87 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2023 Audiokinetic Inc.
+*******************************************************************************/
+
+#ifndef ReverbLabFXBakedData_H
+#define ReverbLabFXBakedData_H
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+#include <array>
+
+// Delayline setup. These static parameters should be defined before compiling
+#define CHANNELS 8
+#define DIFFUSER_STEPS 5
+#define ROOM_SIZE 48.f
+#define VELVET_STAGES 3
+#define VELVET_TAPS 4
+
+// Bump whenever the layout of ReverbLabBakedData in the bank changes
+static const AkUInt32 REVERBLAB_BAKED_DATA_VERSION = 2;
+
+// DSP state derived from the parameters for one sample rate. The authoring plug-in writes it after
+// the parameters in the bank, and the runtime computes it itself when the bank doesn't carry it.
+struct ReverbLabBakedData
+{
+    AkUInt32 uSampleRate;
+
+    // Parameter values this was derived from, taken from the same parameter block
+    AkReal32 fRT;
+    AkReal32 fHFCutoff;
+    AkReal32 fHFAttenuation;
+
+    // Delay layout
+    std::array<AkInt32, CHANNELS> feedbackDelays;
+    std::array<std::array<AkInt32, CHANNELS>, DIFFUSER_STEPS> diffusionDelays;
+    std::array<AkUInt32, DIFFUSER_STEPS> polarityMasks;    // bit c set: flip channel c
+
+    // Velvet diffuser taps per stage and channel
+    std::array<std::array<std::array<AkInt32, VELVET_TAPS>, CHANNELS>, VELVET_STAGES> velvetDelays;
+    std::array<std::array<AkUInt32, CHANNELS>, VELVET_STAGES> velvetSignMasks;    // bit k set: tap k is negative
+
+    // Feedback gain for fRT
+    AkReal32 fDecayGain;
+
+    // High shelf for fHFCutoff / fHFAttenuation: b0, b1, b2, a1, a2, normalised by a0
+    std::array<AkReal32, 5> shelfCoefficients;
+    bool bEnableDamping;
+
+    // Governor tier to start at
+    AkUInt32 uQualityTier;
+};
+
+/// Fill out_rData for the given parameters and sample rate. Deterministic, so the authoring tool
+/// and the runtime fallback always agree.
+void ReverbLabComputeBakedData(AkReal32 in_fRT, AkReal32 in_fHFCutoff, AkReal32 in_fHFAttenuation, AkReal32 in_fCPUBudget,
+    AkUInt32 in_uSampleRate, ReverbLabBakedData& out_rData);
+
+// Bytes of the baked block in the bank, after its version. The parameter values it was derived
+// from are not repeated, and bEnableDamping is written as an AkUInt32.
+static const AkUInt32 REVERBLAB_BAKED_DATA_SIZE = (AkUInt32)(sizeof(AkUInt32)
+    + sizeof(ReverbLabBakedData::feedbackDelays) + sizeof(ReverbLabBakedData::diffusionDelays) + sizeof(ReverbLabBakedData::polarityMasks)
+    + sizeof(ReverbLabBakedData::velvetDelays) + sizeof(ReverbLabBakedData::velvetSignMasks)
+    + sizeof(AkReal32) + sizeof(ReverbLabBakedData::shelfCoefficients) + sizeof(AkUInt32) + sizeof(AkUInt32));
+
+#endif // ReverbLabFXBakedData_H
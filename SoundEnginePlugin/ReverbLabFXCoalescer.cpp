@@ -0,0 +1,306 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2023 Audiokinetic Inc.
+*******************************************************************************/
+
+#include "ReverbLabFX.h"
+
+#include <algorithm>
+
+// Process-wide registry of shared engines, guarded by s_registryLock
+static const AkUInt32 MAX_SHARED_ENGINES = 64;
+static ReverbLabSharedEngine* s_engines[MAX_SHARED_ENGINES] = {};
+static ReverbLabSpinLock s_registryLock;
+
+ReverbLabSharedEngine::Key ReverbLabSharedEngine::Key::FromParams(const ReverbLabParamSnapshot& in_rParams, AkUInt32 in_uSampleRate, AkUniqueID in_uNodeID)
+{
+    Key key;
+    key.fCPUBudget = in_rParams.NonRTPC.fCPUBudget;
+    key.uDiffuserType = in_rParams.NonRTPC.uDiffuserType;
+    key.uSampleRate = in_uSampleRate;
+    key.uNodeID = in_uNodeID;
+    return key;
+}
+
+bool ReverbLabSharedEngine::Key::operator==(const Key& in_rOther) const
+{
+    return fCPUBudget == in_rOther.fCPUBudget
+        && uDiffuserType == in_rOther.uDiffuserType
+        && uSampleRate == in_rOther.uSampleRate
+        && uNodeID == in_rOther.uNodeID;
+}
+
+ReverbLabSharedEngine::ReverbLabSharedEngine(const Key& in_rKey, const ReverbLabRTPCParams& in_rParams, AkUInt32 in_uMaxFrames)
+    : m_key(in_rKey)
+    , m_params(in_rParams)
+    , m_uRefCount(1)
+    , m_pOwner(nullptr)
+    , m_uOwnerTick(0)
+    , m_uWriteSlot(0)
+    , m_uFrameTick(0)
+    , m_bReadSlotRendered(true)
+    , m_uMaxFrames(in_uMaxFrames)
+{
+    m_pReverb = std::make_unique<ReverbLabReverb>(ROOM_SIZE, 2.0);
+    for (AkUInt32 uSlot = 0; uSlot < 2; ++uSlot)
+    {
+        m_accumulators[uSlot].assign(2 * in_uMaxFrames, 0.f);
+        m_uFramesAccumulated[uSlot] = 0;
+    }
+}
+
+ReverbLabSharedEngine* ReverbLabSharedEngine::FindLocked(const Key& in_rKey, AkUInt32 in_uMaxFrames)
+{
+    for (AkUInt32 i = 0; i < MAX_SHARED_ENGINES; ++i)
+    {
+        if (s_engines[i] && s_engines[i]->m_key == in_rKey && s_engines[i]->m_uMaxFrames >= in_uMaxFrames)
+            return s_engines[i];
+    }
+    return nullptr;
+}
+
+ReverbLabSharedEngine* ReverbLabSharedEngine::Join(const Key& in_rKey, AkUInt32 in_uMaxFrames)
+{
+    s_registryLock.Lock();
+    ReverbLabSharedEngine* pEngine = FindLocked(in_rKey, in_uMaxFrames);
+    if (pEngine)
+        ++pEngine->m_uRefCount;
+    s_registryLock.Unlock();
+
+    return pEngine;
+}
+
+ReverbLabSharedEngine* ReverbLabSharedEngine::Create(AK::IAkPluginMemAlloc* in_pAllocator, const Key& in_rKey, const ReverbLabRTPCParams& in_rParams,
+    AkUInt32 in_uMaxFrames)
+{
+    return AK_PLUGIN_NEW(in_pAllocator, ReverbLabSharedEngine(in_rKey, in_rParams, in_uMaxFrames));
+}
+
+ReverbLabSharedEngine* ReverbLabSharedEngine::Publish(AK::IAkPluginMemAlloc* in_pAllocator, ReverbLabSharedEngine* in_pEngine)
+{
+    s_registryLock.Lock();
+    ReverbLabSharedEngine* pEngine = FindLocked(in_pEngine->m_key, in_pEngine->m_uMaxFrames);
+    if (pEngine)
+    {
+        ++pEngine->m_uRefCount;
+    }
+    else
+    {
+        for (AkUInt32 i = 0; i < MAX_SHARED_ENGINES; ++i)
+        {
+            if (!s_engines[i])
+            {
+                s_engines[i] = pEngine = in_pEngine;
+                break;
+            }
+        }
+    }
+    s_registryLock.Unlock();
+
+    // Lost the race, or no room: ours was never visible to anyone else
+    if (pEngine != in_pEngine)
+        AK_PLUGIN_DELETE(in_pAllocator, in_pEngine);
+
+    return pEngine;
+}
+
+ReverbLabSharedEngine* ReverbLabSharedEngine::Move(AK::IAkPluginMemAlloc* in_pAllocator, ReverbLabSharedEngine* in_pEngine, const Key& in_rKey,
+    AkUInt32 in_uMaxFrames, const void* in_pInstance)
+{
+    s_registryLock.Lock();
+    ReverbLabSharedEngine* pEngine = FindLocked(in_rKey, in_uMaxFrames);
+    if (pEngine)
+    {
+        ++pEngine->m_uRefCount;
+    }
+    else if (in_pEngine->m_uRefCount == 1)
+    {
+        // Nobody else renders it, and nobody can join it before we're done
+        in_pEngine->m_key = in_rKey;
+        in_pEngine->m_pReverb->setVelvetDiffuser(in_rKey.uDiffuserType == DIFFUSER_VELVET);
+        pEngine = in_pEngine;
+    }
+    s_registryLock.Unlock();
+
+    // Leave the old engine only once we have the new one
+    if (pEngine != in_pEngine)
+        Release(in_pAllocator, in_pEngine, in_pInstance);
+
+    return pEngine;
+}
+
+void ReverbLabSharedEngine::Release(AK::IAkPluginMemAlloc* in_pAllocator, ReverbLabSharedEngine* in_pEngine, const void* in_pInstance)
+{
+    bool bDelete = false;
+
+    s_registryLock.Lock();
+    if (--in_pEngine->m_uRefCount == 0)
+    {
+        for (AkUInt32 i = 0; i < MAX_SHARED_ENGINES; ++i)
+        {
+            if (s_engines[i] == in_pEngine)
+                s_engines[i] = nullptr;
+        }
+        bDelete = true;
+    }
+    else
+    {
+        in_pEngine->ReleaseOwnership(in_pInstance);
+    }
+    s_registryLock.Unlock();
+
+    if (bDelete)
+        AK_PLUGIN_DELETE(in_pAllocator, in_pEngine);
+}
+
+void ReverbLabSharedEngine::FollowParams(const ReverbLabRTPCParams& in_rParams)
+{
+    // Same updates our own reverb gets from Execute(); the delay lines and tail are kept
+    if (in_rParams.fRT != m_params.fRT)
+    {
+        m_pReverb->setRt60(in_rParams.fRT);
+    }
+    if (in_rParams.fHFCutoff != m_params.fHFCutoff || in_rParams.fHFAttenuation != m_params.fHFAttenuation)
+    {
+        m_pReverb->setDamping(in_rParams.fHFCutoff, in_rParams.fHFAttenuation);
+    }
+
+    m_lock.Lock();
+    m_params = in_rParams;
+    m_lock.Unlock();
+}
+
+bool ReverbLabSharedEngine::Matches(const ReverbLabRTPCParams& in_rParams)
+{
+    // Dry/wet and output gain are applied per instance, they don't matter here
+    m_lock.Lock();
+    const bool bMatches = in_rParams.fRT == m_params.fRT
+        && in_rParams.fHFCutoff == m_params.fHFCutoff
+        && in_rParams.fHFAttenuation == m_params.fHFAttenuation
+        && in_rParams.fStereoWidth == m_params.fStereoWidth;
+    m_lock.Unlock();
+    return bMatches;
+}
+
+bool ReverbLabSharedEngine::BeginFrame(const void* in_pInstance, AkUInt32 in_uBufferTick)
+{
+    m_lock.Lock();
+
+    // After the swap nobody writes the other slot, so RenderAdd can read it without the lock
+    if (in_uBufferTick != m_uFrameTick)
+    {
+        // Nobody rendered the previous frame's input, e.g. the owner was bypassed: render it one frame
+        // late with the input of the frame that just ended, rather than lose it
+        if (!m_bReadSlotRendered)
+        {
+            const AkUInt32 uReadSlot = m_uWriteSlot ^ 1;
+            const AkUInt32 uFrames = m_uFramesAccumulated[uReadSlot];
+            AkReal32* pFrom = m_accumulators[uReadSlot].data();
+            AkReal32* pTo = m_accumulators[m_uWriteSlot].data();
+            for (AkUInt32 i = 0; i < 2 * uFrames; ++i)
+                pTo[i] += pFrom[i];
+            std::fill(pFrom, pFrom + 2 * uFrames, 0.f);
+            m_uFramesAccumulated[m_uWriteSlot] = std::max(m_uFramesAccumulated[m_uWriteSlot], uFrames);
+            m_uFramesAccumulated[uReadSlot] = 0;
+        }
+        m_uWriteSlot ^= 1;
+        m_uFrameTick = in_uBufferTick;
+        m_bReadSlotRendered = false;
+    }
+
+    // Take over from an owner that stopped executing without releasing, e.g. a virtual voice
+    if (!m_pOwner || (m_pOwner != in_pInstance && in_uBufferTick - m_uOwnerTick > 1))
+        m_pOwner = in_pInstance;
+
+    // Render each frame once, even if ownership changed hands after it was rendered
+    const bool bRender = m_pOwner == in_pInstance && !m_bReadSlotRendered;
+    if (m_pOwner == in_pInstance)
+        m_uOwnerTick = in_uBufferTick;
+    if (bRender)
+        m_bReadSlotRendered = true;
+
+    m_lock.Unlock();
+    return bRender;
+}
+
+void ReverbLabSharedEngine::ReleaseOwnership(const void* in_pInstance)
+{
+    m_lock.Lock();
+    if (m_pOwner == in_pInstance)
+        m_pOwner = nullptr;
+    m_lock.Unlock();
+}
+
+void ReverbLabSharedEngine::Accumulate(const AkReal32* in_pL, const AkReal32* in_pR, AkUInt32 in_uFrames, AkReal32 in_fScale)
+{
+    const AkUInt32 uFrames = std::min(in_uFrames, m_uMaxFrames);
+
+    m_lock.Lock();
+    AkReal32* AK_RESTRICT pAccumulator = m_accumulators[m_uWriteSlot].data();
+    for (AkUInt32 i = 0; i < uFrames; ++i)
+    {
+        pAccumulator[2 * i] += in_pL[i] * in_fScale;
+        pAccumulator[2 * i + 1] += in_pR[i] * in_fScale;
+    }
+    m_uFramesAccumulated[m_uWriteSlot] = std::max(m_uFramesAccumulated[m_uWriteSlot], uFrames);
+    m_lock.Unlock();
+}
+
+void ReverbLabSharedEngine::RenderAdd(AkReal32* io_pL, AkReal32* io_pR, AkUInt32 in_uFrames)
+{
+    const AkUInt32 uReadSlot = m_uWriteSlot ^ 1;
+    AkReal32* AK_RESTRICT pAccumulator = m_accumulators[uReadSlot].data();
+    const AkUInt32 uFrames = std::min(in_uFrames, m_uMaxFrames);
+    const AkReal32 fStereoWidth = m_params.fStereoWidth;
+
+    for (AkUInt32 i = 0; i < uFrames; ++i)
+    {
+        // Same signal path as ReverbLabFX::Execute, minus dry/wet and gain already applied on input
+        std::array<AkReal32, 2> stereoInput = { pAccumulator[2 * i], pAccumulator[2 * i + 1] };
+        std::array<AkReal32, 2> stereoOutput;
+        std::array<AkReal32, CHANNELS> multiChannelInput;
+        std::array<AkReal32, CHANNELS> multiChannelOutput;
+
+        m_multiChannelMixer.stereoToMulti(stereoInput, multiChannelInput);
+        multiChannelOutput = m_pReverb->process(multiChannelInput);
+        m_multiChannelMixer.multiToStereo(multiChannelOutput, stereoOutput);
+
+        AkReal32 revL = stereoOutput[0] * GAIN_CALIBR;
+        AkReal32 revR = stereoOutput[1] * GAIN_CALIBR;
+        AkReal32 revM = (revL + revR) * 0.5f;
+        AkReal32 revS = (revL - revR) * 0.5f * fStereoWidth;
+
+        io_pL[i] += revM - revS;
+        io_pR[i] += revM + revS;
+
+        if ((i + 1) % 256 == 0)
+        {
+            m_pReverb->filterSnapToZero();
+        }
+    }
+
+    // Ready to be filled again after the next swap
+    std::fill(pAccumulator, pAccumulator + 2 * m_uFramesAccumulated[uReadSlot], 0.f);
+    m_uFramesAccumulated[uReadSlot] = 0;
+}
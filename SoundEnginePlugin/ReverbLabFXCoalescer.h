@@ -0,0 +1,151 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2023 Audiokinetic Inc.
+*******************************************************************************/
+
+#ifndef ReverbLabFXCoalescer_H
+#define ReverbLabFXCoalescer_H
+
+#include "ReverbLabFXParams.h"
+#include "ReverbLabFXReverb.h"
+
+#include "external/mix.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Busy-wait lock for the few short critical sections below; never held across DSP work
+class ReverbLabSpinLock
+{
+public:
+    void Lock() { while (m_flag.test_and_set(std::memory_order_acquire)) {} }
+    void Unlock() { m_flag.clear(std::memory_order_release); }
+
+private:
+    std::atomic_flag m_flag = ATOMIC_FLAG_INIT;
+};
+
+/// One reverb network shared by every instance whose parameters shape the wet signal the same way.
+/// Every instance adds its input, scaled by its own wet mix and output gain, with Accumulate().
+/// One owner instance renders the sum once per frame with RenderAdd() and outputs the whole wet
+/// signal. Frames are told apart by the sound engine's buffer tick: input accumulated during one
+/// frame is rendered during the next, so the shared wet signal is one block late.
+/// Summing is only right for instances with the same wet parameters, so an instance only adds
+/// its input while its decay, damping and stereo width match the engine's (see Matches()).
+class ReverbLabSharedEngine
+{
+public:
+    /// The structural parameters an engine is shared on. RTPC-driven parameters are not part of it:
+    /// decay, damping and stereo width follow the rendering instance in place, like our own reverb
+    /// does, and instances whose values differ render on their own reverb instead. Dry/wet and
+    /// output gain are applied to each instance's input because the network is linear.
+    /// The node ID keeps instances inserted on different busses or sounds on separate engines, since
+    /// the wet signal is output by whichever instance renders.
+    struct Key
+    {
+        AkReal32 fCPUBudget;
+        AkUInt32 uDiffuserType;
+        AkUInt32 uSampleRate;
+        AkUniqueID uNodeID;
+
+        static Key FromParams(const ReverbLabParamSnapshot& in_rParams, AkUInt32 in_uSampleRate, AkUniqueID in_uNodeID);
+        bool operator==(const Key& in_rOther) const;
+    };
+
+    /// Parameters that are part of the key, as a change mask
+    static const AkUInt32 KEY_PARAMS_MASK = (1u << PARAM_CPUBUDGET_ID) | (1u << PARAM_DIFFUSERTYPE_ID);
+
+    /// Join the engine for in_rKey only if it already exists. Never allocates, so it is safe from Execute().
+    static ReverbLabSharedEngine* Join(const Key& in_rKey, AkUInt32 in_uMaxFrames);
+
+    /// Allocate an engine for in_rKey that nobody else can see yet. The caller configures Reverb()
+    /// for in_rParams, then hands it to Publish(). Returns nullptr on failure.
+    static ReverbLabSharedEngine* Create(AK::IAkPluginMemAlloc* in_pAllocator, const Key& in_rKey, const ReverbLabRTPCParams& in_rParams,
+        AkUInt32 in_uMaxFrames);
+
+    /// Make a configured engine from Create() joinable. If another instance published one for the
+    /// same key in the meantime, in_pEngine is deleted and that one is joined instead. Returns the
+    /// engine to use, or nullptr if the registry is full.
+    static ReverbLabSharedEngine* Publish(AK::IAkPluginMemAlloc* in_pAllocator, ReverbLabSharedEngine* in_pEngine);
+
+    /// Move from in_pEngine to the engine for a new key, joining it before leaving the old one. With no
+    /// engine for the new key, an instance alone on in_pEngine takes it along and switches its diffuser
+    /// in place; otherwise it leaves in_pEngine to the others and gets nullptr. Never allocates.
+    static ReverbLabSharedEngine* Move(AK::IAkPluginMemAlloc* in_pAllocator, ReverbLabSharedEngine* in_pEngine, const Key& in_rKey,
+        AkUInt32 in_uMaxFrames, const void* in_pInstance);
+
+    /// Leave the engine. Ownership passes on to the next instance that executes; the last one out deletes it.
+    static void Release(AK::IAkPluginMemAlloc* in_pAllocator, ReverbLabSharedEngine* in_pEngine, const void* in_pInstance);
+
+    const Key& GetKey() const { return m_key; }
+    ReverbLabReverb& Reverb() { return *m_pReverb; }
+
+    /// Every instance calls this before Accumulate(). The first call of a new frame swaps the accumulators.
+    /// Returns true if in_pInstance must render this frame with RenderAdd(): it takes ownership when nobody
+    /// has it, or when the owner missed a whole frame without giving it up, so input never piles up unrendered.
+    /// Input of a frame nobody rendered is rendered with the next frame's.
+    bool BeginFrame(const void* in_pInstance, AkUInt32 in_uBufferTick);
+
+    /// Stop rendering if in_pInstance is the owner, e.g. when it goes virtual. The next instance to execute takes over.
+    void ReleaseOwnership(const void* in_pInstance);
+
+    /// Owner only: bring decay, damping and stereo width to the owner's values, in place.
+    void FollowParams(const ReverbLabRTPCParams& in_rParams);
+
+    /// True if in_rParams shape the wet signal like the values the engine runs with.
+    bool Matches(const ReverbLabRTPCParams& in_rParams);
+
+    /// Add one block of stereo input, multiplied by in_fScale.
+    void Accumulate(const AkReal32* in_pL, const AkReal32* in_pR, AkUInt32 in_uFrames, AkReal32 in_fScale);
+
+    /// Owner only: run the network over the previous frame's input and add the wet signal to the buffers.
+    void RenderAdd(AkReal32* io_pL, AkReal32* io_pR, AkUInt32 in_uFrames);
+
+private:
+    ReverbLabSharedEngine(const Key& in_rKey, const ReverbLabRTPCParams& in_rParams, AkUInt32 in_uMaxFrames);
+
+    // Registry lookup; s_registryLock must be held
+    static ReverbLabSharedEngine* FindLocked(const Key& in_rKey, AkUInt32 in_uMaxFrames);
+
+    Key m_key;
+    ReverbLabRTPCParams m_params;   // What the network currently runs with, written under m_lock
+    AkUInt32 m_uRefCount;
+    const void* m_pOwner;
+    AkUInt32 m_uOwnerTick;          // Last frame the owner executed
+
+    std::unique_ptr<ReverbLabReverb> m_pReverb;
+    signalsmith::mix::StereoMultiMixer<AkReal32, CHANNELS> m_multiChannelMixer;
+
+    // Two interleaved stereo accumulators: one being filled, one being rendered
+    ReverbLabSpinLock m_lock;
+    std::vector<AkReal32> m_accumulators[2];
+    AkUInt32 m_uFramesAccumulated[2];
+    AkUInt32 m_uWriteSlot;
+    AkUInt32 m_uFrameTick;          // Frame the write slot is filled for
+    bool m_bReadSlotRendered;       // Some instance rendered, or is rendering, this frame
+    AkUInt32 m_uMaxFrames;
+};
+
+#endif // ReverbLabFXCoalescer_H
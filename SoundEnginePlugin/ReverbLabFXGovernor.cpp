@@ -0,0 +1,167 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2023 Audiokinetic Inc.
+*******************************************************************************/
+
+#include "ReverbLabFXGovernor.h"
+
+#include <AK/Tools/Common/AkPlatformFuncs.h>
+
+#include <atomic>
+
+// Weight of the newest block in the smoothed load
+static const AkReal32 LOAD_SMOOTHING = 0.25f;
+// Consecutive blocks over budget before dropping one tier
+static const AkUInt32 STEP_DOWN_BLOCKS = 4;
+// Consecutive blocks under HEADROOM_RATIO * budget before raising one tier
+static const AkUInt32 STEP_UP_BLOCKS = 64;
+static const AkReal32 HEADROOM_RATIO = 0.6f;
+
+// Global budget: buffer tick of the frame being summed in the high 32 bits, nanoseconds spent
+// in it so far by every global-budget instance in the low 32 bits
+static std::atomic<AkUInt64> s_globalFrameCost(0);
+// Nanoseconds spent in the last complete frame
+static std::atomic<AkUInt32> s_globalLastFrameCost(0);
+
+// Add one instance's cost to its frame and return the total of the last complete frame
+static AkUInt32 AddGlobalCost(AkUInt32 in_uBufferTick, AkUInt32 in_uNanoseconds)
+{
+    AkUInt64 uOld = s_globalFrameCost.load(std::memory_order_relaxed);
+    AkUInt64 uNew;
+    do
+    {
+        const AkUInt32 uOldTick = (AkUInt32)(uOld >> 32);
+        const AkUInt32 uOldCost = (AkUInt32)uOld;
+        if (uOldTick == in_uBufferTick)
+            uNew = uOld + (in_uNanoseconds < 0xFFFFFFFFu - uOldCost ? in_uNanoseconds : 0xFFFFFFFFu - uOldCost);
+        else
+            uNew = ((AkUInt64)in_uBufferTick << 32) | in_uNanoseconds;
+    } while (!s_globalFrameCost.compare_exchange_weak(uOld, uNew, std::memory_order_relaxed));
+
+    // First instance of a new frame: the previous one is complete, unless frames were skipped
+    const AkUInt32 uOldTick = (AkUInt32)(uOld >> 32);
+    if (uOldTick != in_uBufferTick)
+        s_globalLastFrameCost.store(uOldTick + 1 == in_uBufferTick ? (AkUInt32)uOld : 0, std::memory_order_relaxed);
+
+    return s_globalLastFrameCost.load(std::memory_order_relaxed);
+}
+
+ReverbLabFXGovernor::ReverbLabFXGovernor()
+    : m_fTicksPerSecond(0.)
+    , m_iBlockStart(0)
+    , m_fBudget(0.f)
+    , m_bGlobal(false)
+    , m_fAverageLoad(0.f)
+    , m_uTier(0)
+    , m_uMaxTier(0)
+    , m_uOverBudgetBlocks(0)
+    , m_uHeadroomBlocks(0)
+{
+}
+
+void ReverbLabFXGovernor::Init(AkUInt32 in_uMaxTier)
+{
+    AkInt64 iFrequency = 0;
+    AKPLATFORM::PerformanceFrequency(&iFrequency);
+    m_fTicksPerSecond = (AkReal64)iFrequency;
+    m_uMaxTier = in_uMaxTier;
+}
+
+void ReverbLabFXGovernor::SetMaxTier(AkUInt32 in_uMaxTier)
+{
+    m_uMaxTier = in_uMaxTier;
+    m_uOverBudgetBlocks = 0;
+    if (m_uTier > m_uMaxTier)
+        m_uTier = m_uMaxTier;
+}
+
+void ReverbLabFXGovernor::SetBudget(AkReal32 in_fBudgetPercent, bool in_bGlobal)
+{
+    m_fBudget = in_fBudgetPercent;
+    m_bGlobal = in_bGlobal;
+    m_uOverBudgetBlocks = 0;
+    m_uHeadroomBlocks = 0;
+    if (!IsEnabled())
+    {
+        m_uTier = 0;
+        m_fAverageLoad = 0.f;
+    }
+}
+
+void ReverbLabFXGovernor::StartAtTier(AkUInt32 in_uTier)
+{
+    m_uTier = in_uTier < m_uMaxTier ? in_uTier : m_uMaxTier;
+}
+
+void ReverbLabFXGovernor::BeginBlock()
+{
+    AKPLATFORM::PerformanceCounter(&m_iBlockStart);
+}
+
+AkUInt32 ReverbLabFXGovernor::EndBlock(AkUInt32 in_uFrames, AkUInt32 in_uSampleRate, AkUInt32 in_uBufferTick)
+{
+    if (!IsEnabled() || in_uFrames == 0 || m_fTicksPerSecond <= 0.)
+        return m_uTier;
+
+    AkInt64 iBlockEnd = 0;
+    AKPLATFORM::PerformanceCounter(&iBlockEnd);
+
+    // Load in percent of the real-time duration of this block, or of the last whole frame for a global budget
+    AkReal64 fElapsed = (AkReal64)(iBlockEnd - m_iBlockStart) / m_fTicksPerSecond;
+    if (m_bGlobal)
+    {
+        const AkReal64 fNanoseconds = fElapsed * 1e9;
+        fElapsed = 1e-9 * (AkReal64)AddGlobalCost(in_uBufferTick, fNanoseconds < 4e9 ? (AkUInt32)fNanoseconds : 4000000000u);
+    }
+    AkReal64 fBlockDuration = (AkReal64)in_uFrames / (AkReal64)in_uSampleRate;
+    AkReal32 fLoad = (AkReal32)(100. * fElapsed / fBlockDuration);
+    m_fAverageLoad += LOAD_SMOOTHING * (fLoad - m_fAverageLoad);
+
+    if (m_fAverageLoad > m_fBudget)
+    {
+        m_uHeadroomBlocks = 0;
+        if (++m_uOverBudgetBlocks >= STEP_DOWN_BLOCKS && m_uTier < m_uMaxTier)
+        {
+            ++m_uTier;
+            m_uOverBudgetBlocks = 0;
+        }
+    }
+    else if (m_fAverageLoad < m_fBudget * HEADROOM_RATIO)
+    {
+        m_uOverBudgetBlocks = 0;
+        if (++m_uHeadroomBlocks >= STEP_UP_BLOCKS && m_uTier > 0)
+        {
+            --m_uTier;
+            m_uHeadroomBlocks = 0;
+        }
+    }
+    else
+    {
+        // Inside the hysteresis band: hold the current tier
+        m_uOverBudgetBlocks = 0;
+        m_uHeadroomBlocks = 0;
+    }
+
+    return m_uTier;
+}
@@ -0,0 +1,82 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2023 Audiokinetic Inc.
+*******************************************************************************/
+
+#ifndef ReverbLabFXGovernor_H
+#define ReverbLabFXGovernor_H
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+/// Measures the cost of each Execute() against a CPU budget and picks a reverb quality tier.
+/// Tier 0 is full quality, higher tiers are cheaper. It steps down quickly when over budget,
+/// and only steps back up after a sustained stretch of headroom so it doesn't oscillate.
+/// With a global budget, the cost of every global-budget instance in the process is summed per
+/// audio frame and all of them govern against that total, so adding voices triggers a step-down
+/// even though each instance costs the same as before.
+class ReverbLabFXGovernor
+{
+public:
+    ReverbLabFXGovernor();
+
+    /// Set the cheapest tier the governor may select.
+    void Init(AkUInt32 in_uMaxTier);
+
+    /// Change the cheapest tier, e.g. when the DSP switches to a variant with fewer useful tiers.
+    void SetMaxTier(AkUInt32 in_uMaxTier);
+
+    /// Budget in percent of the block duration, for this instance alone or for all global-budget
+    /// instances together. 0 disables the governor and restores tier 0.
+    void SetBudget(AkReal32 in_fBudgetPercent, bool in_bGlobal);
+
+    bool IsEnabled() const { return m_fBudget > 0.f; }
+    bool IsGlobal() const { return m_bGlobal; }
+
+    /// Start from a cheaper tier than full quality, e.g. the one baked for a tight budget.
+    void StartAtTier(AkUInt32 in_uTier);
+
+    /// Mark the start of the work to measure.
+    void BeginBlock();
+
+    /// Measure the work since BeginBlock() and return the tier to use from now on.
+    /// in_uBufferTick identifies the audio frame, for summing the global budget's cost.
+    AkUInt32 EndBlock(AkUInt32 in_uFrames, AkUInt32 in_uSampleRate, AkUInt32 in_uBufferTick);
+
+    AkUInt32 GetTier() const { return m_uTier; }
+    AkReal32 GetAverageLoad() const { return m_fAverageLoad; }
+
+private:
+    AkReal64 m_fTicksPerSecond;
+    AkInt64 m_iBlockStart;
+
+    AkReal32 m_fBudget;
+    bool m_bGlobal;
+    AkReal32 m_fAverageLoad;
+    AkUInt32 m_uTier;
+    AkUInt32 m_uMaxTier;
+    AkUInt32 m_uOverBudgetBlocks;
+    AkUInt32 m_uHeadroomBlocks;
+};
+
+#endif // ReverbLabFXGovernor_H
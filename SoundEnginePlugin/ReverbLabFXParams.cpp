@@ -29,6 +29,11 @@ the specific language governing permissions and limitations under the License.
 #include <AK/Tools/Common/AkBankReadHelpers.h>
 
 ReverbLabFXParams::ReverbLabFXParams()
+    : m_bHasBakedData(false)
+    , m_uWriteIndex(0)
+    , m_uReadIndex(1)
+    , m_uMiddleIndex(2)
+    , m_uChangeMask(0)
 {
 }
 
@@ -37,10 +42,16 @@ ReverbLabFXParams::~ReverbLabFXParams()
 }
 
 ReverbLabFXParams::ReverbLabFXParams(const ReverbLabFXParams& in_rParams)
+    : m_bakedData(in_rParams.m_bakedData)
+    , m_bHasBakedData(in_rParams.m_bHasBakedData)
+    , m_uWriteIndex(0)
+    , m_uReadIndex(1)
+    , m_uMiddleIndex(2)
+    , m_uChangeMask(0)
 {
     RTPC = in_rParams.RTPC;
     NonRTPC = in_rParams.NonRTPC;
-    m_paramChangeHandler.SetAllParamChanges();
+    PublishParams(SNAPSHOT_ALL_CHANGES);
 }
 
 AK::IAkPluginParam* ReverbLabFXParams::Clone(AK::IAkPluginMemAlloc* in_pAllocator)
@@ -59,7 +70,11 @@ AKRESULT ReverbLabFXParams::Init(AK::IAkPluginMemAlloc* in_pAllocator, const voi
         RTPC.fStereoWidth = 1.f;
         RTPC.fDryWetMix = 50.f;
         RTPC.fOutputGain = 0.f;
-        m_paramChangeHandler.SetAllParamChanges();
+        NonRTPC.fCPUBudget = 0.f;
+        NonRTPC.uDiffuserType = DIFFUSER_HADAMARD;
+        NonRTPC.bCoalesce = false;
+        NonRTPC.uBudgetScope = BUDGET_SCOPE_INSTANCE;
+        PublishParams(SNAPSHOT_ALL_CHANGES);
         return AK_Success;
     }
 
@@ -77,6 +92,10 @@ AKRESULT ReverbLabFXParams::SetParamsBlock(const void* in_pParamsBlock, AkUInt32
     AKRESULT eResult = AK_Success;
     AkUInt8* pParamsBlock = (AkUInt8*)in_pParamsBlock;
 
+    // Every bank carries the RTPC parameters; a shorter block can't be read at all
+    if (in_ulBlockSize < 6 * sizeof(AkReal32))
+        return AK_Fail;
+
     // Read bank data here
     RTPC.fRT = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
     RTPC.fHFCutoff = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
@@ -84,8 +103,54 @@ AKRESULT ReverbLabFXParams::SetParamsBlock(const void* in_pParamsBlock, AkUInt32
     RTPC.fStereoWidth = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
     RTPC.fDryWetMix = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
     RTPC.fOutputGain = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+
+    // Added by later plug-in versions, in this order: banks written before keep the defaults
+    NonRTPC.fCPUBudget = 0.f;
+    NonRTPC.uDiffuserType = DIFFUSER_HADAMARD;
+    NonRTPC.bCoalesce = false;
+    NonRTPC.uBudgetScope = BUDGET_SCOPE_INSTANCE;
+    if (in_ulBlockSize >= sizeof(AkReal32))
+        NonRTPC.fCPUBudget = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    if (in_ulBlockSize >= sizeof(AkUInt32))
+        NonRTPC.uDiffuserType = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+    if (in_ulBlockSize >= sizeof(AkUInt32))
+        NonRTPC.bCoalesce = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize) != 0;
+    if (in_ulBlockSize >= sizeof(AkUInt32))
+        NonRTPC.uBudgetScope = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+
+    // Optional derived DSP state written by the authoring plug-in (see ReverbLabPlugin::GetBankParameters).
+    // Only a complete block of this version is used; anything else left over is an error.
+    m_bHasBakedData = false;
+    if (in_ulBlockSize == sizeof(AkUInt32) + REVERBLAB_BAKED_DATA_SIZE &&
+        READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize) == REVERBLAB_BAKED_DATA_VERSION)
+    {
+        m_bakedData.fRT = RTPC.fRT;
+        m_bakedData.fHFCutoff = RTPC.fHFCutoff;
+        m_bakedData.fHFAttenuation = RTPC.fHFAttenuation;
+        m_bakedData.uSampleRate = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+        for (AkInt32& delay : m_bakedData.feedbackDelays)
+            delay = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+        for (auto& stepDelays : m_bakedData.diffusionDelays)
+            for (AkInt32& delay : stepDelays)
+                delay = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+        for (AkUInt32& mask : m_bakedData.polarityMasks)
+            mask = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+        for (auto& stageDelays : m_bakedData.velvetDelays)
+            for (auto& channelDelays : stageDelays)
+                for (AkInt32& delay : channelDelays)
+                    delay = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+        for (auto& stageMasks : m_bakedData.velvetSignMasks)
+            for (AkUInt32& mask : stageMasks)
+                mask = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+        m_bakedData.fDecayGain = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+        for (AkReal32& coefficient : m_bakedData.shelfCoefficients)
+            coefficient = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+        m_bakedData.bEnableDamping = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize) != 0;
+        m_bakedData.uQualityTier = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+        m_bHasBakedData = true;
+    }
     CHECKBANKDATASIZE(in_ulBlockSize, eResult);
-    m_paramChangeHandler.SetAllParamChanges();
+    PublishParams(SNAPSHOT_ALL_CHANGES);
 
     return eResult;
 }
@@ -99,27 +164,43 @@ AKRESULT ReverbLabFXParams::SetParam(AkPluginParamID in_paramID, const void* in_
     {
     case PARAM_RT_ID:
         RTPC.fRT = *((AkReal32*)in_pValue);
-        m_paramChangeHandler.SetParamChange(PARAM_RT_ID);
+        PublishParams(1u << PARAM_RT_ID);
         break;
     case PARAM_HFCUTOFF_ID:
         RTPC.fHFCutoff = *((AkReal32*)in_pValue);
-        m_paramChangeHandler.SetParamChange(PARAM_HFCUTOFF_ID);
+        PublishParams(1u << PARAM_HFCUTOFF_ID);
         break;
     case PARAM_HFATTENUATION_ID:
         RTPC.fHFAttenuation = *((AkReal32*)in_pValue);
-        m_paramChangeHandler.SetParamChange(PARAM_HFATTENUATION_ID);
+        PublishParams(1u << PARAM_HFATTENUATION_ID);
         break;
     case PARAM_STEREOWIDTH_ID:
         RTPC.fStereoWidth = *((AkReal32*)in_pValue);
-        m_paramChangeHandler.SetParamChange(PARAM_STEREOWIDTH_ID);
+        PublishParams(1u << PARAM_STEREOWIDTH_ID);
         break;
     case PARAM_DRYWETMIX_ID:
         RTPC.fDryWetMix = *((AkReal32*)in_pValue);
-        m_paramChangeHandler.SetParamChange(PARAM_DRYWETMIX_ID);
+        PublishParams(1u << PARAM_DRYWETMIX_ID);
         break;
     case PARAM_OUTPUTGAIN:
         RTPC.fOutputGain = *((AkReal32*)in_pValue);
-        m_paramChangeHandler.SetParamChange(PARAM_OUTPUTGAIN);
+        PublishParams(1u << PARAM_OUTPUTGAIN);
+        break;
+    case PARAM_CPUBUDGET_ID:
+        NonRTPC.fCPUBudget = *((AkReal32*)in_pValue);
+        PublishParams(1u << PARAM_CPUBUDGET_ID);
+        break;
+    case PARAM_DIFFUSERTYPE_ID:
+        NonRTPC.uDiffuserType = (AkUInt32)*((AkInt32*)in_pValue);
+        PublishParams(1u << PARAM_DIFFUSERTYPE_ID);
+        break;
+    case PARAM_COALESCE_ID:
+        NonRTPC.bCoalesce = *((bool*)in_pValue);
+        PublishParams(1u << PARAM_COALESCE_ID);
+        break;
+    case PARAM_BUDGETSCOPE_ID:
+        NonRTPC.uBudgetScope = (AkUInt32)*((AkInt32*)in_pValue);
+        PublishParams(1u << PARAM_BUDGETSCOPE_ID);
         break;
     default:
         eResult = AK_InvalidParameter;
@@ -128,3 +209,33 @@ AKRESULT ReverbLabFXParams::SetParam(AkPluginParamID in_paramID, const void* in_
 
     return eResult;
 }
+
+const ReverbLabBakedData* ReverbLabFXParams::GetBakedData(AkUInt32 in_uSampleRate) const
+{
+    return (m_bHasBakedData && m_bakedData.uSampleRate == in_uSampleRate) ? &m_bakedData : nullptr;
+}
+
+void ReverbLabFXParams::PublishParams(AkUInt32 in_uChangeMask)
+{
+    // Fill the slot only the writer owns, then hand it over as the latest one
+    m_snapshots[m_uWriteIndex].RTPC = RTPC;
+    m_snapshots[m_uWriteIndex].NonRTPC = NonRTPC;
+    m_uWriteIndex = m_uMiddleIndex.exchange(m_uWriteIndex | SNAPSHOT_NEW_BIT, std::memory_order_acq_rel) & ~SNAPSHOT_NEW_BIT;
+
+    // Flag after publishing, so a reader that sees the flag also sees the values
+    m_uChangeMask.fetch_or(in_uChangeMask, std::memory_order_release);
+}
+
+void ReverbLabFXParams::AcquireSnapshot(ReverbLabParamSnapshot& out_rSnapshot)
+{
+    out_rSnapshot.uChangeMask = m_uChangeMask.exchange(0, std::memory_order_acquire);
+
+    // Take the middle slot only if the writer has put something new there since last time
+    if (m_uMiddleIndex.load(std::memory_order_relaxed) & SNAPSHOT_NEW_BIT)
+    {
+        m_uReadIndex = m_uMiddleIndex.exchange(m_uReadIndex, std::memory_order_acq_rel) & ~SNAPSHOT_NEW_BIT;
+    }
+
+    out_rSnapshot.RTPC = m_snapshots[m_uReadIndex].RTPC;
+    out_rSnapshot.NonRTPC = m_snapshots[m_uReadIndex].NonRTPC;
+}
@@ -27,8 +27,10 @@ the specific language governing permissions and limitations under the License.
 #ifndef ReverbLabFXParams_H
 #define ReverbLabFXParams_H
 
+#include "ReverbLabFXBakedData.h"
+
 #include <AK/SoundEngine/Common/IAkPlugin.h>
-#include <AK/Plugin/PluginServices/AkFXParameterChangeHandler.h>
+#include <atomic>
 
 // Add parameters IDs here, those IDs should map to the AudioEnginePropertyID
 // attributes in the xml property definition.
@@ -38,7 +40,19 @@ static const AkPluginParamID PARAM_HFATTENUATION_ID = 2;
 static const AkPluginParamID PARAM_STEREOWIDTH_ID = 3;
 static const AkPluginParamID PARAM_DRYWETMIX_ID = 4;
 static const AkPluginParamID PARAM_OUTPUTGAIN = 5;
-static const AkUInt32 NUM_PARAMS = 6;
+static const AkPluginParamID PARAM_CPUBUDGET_ID = 6;
+static const AkPluginParamID PARAM_DIFFUSERTYPE_ID = 7;
+static const AkPluginParamID PARAM_COALESCE_ID = 8;
+static const AkPluginParamID PARAM_BUDGETSCOPE_ID = 9;
+static const AkUInt32 NUM_PARAMS = 10;
+
+// Values of the DiffuserType property
+static const AkUInt32 DIFFUSER_HADAMARD = 0;
+static const AkUInt32 DIFFUSER_VELVET = 1;
+
+// Values of the BudgetScope property
+static const AkUInt32 BUDGET_SCOPE_INSTANCE = 0;
+static const AkUInt32 BUDGET_SCOPE_GLOBAL = 1;
 
 struct ReverbLabRTPCParams
 {
@@ -52,6 +66,20 @@ struct ReverbLabRTPCParams
 
 struct ReverbLabNonRTPCParams
 {
+    AkReal32 fCPUBudget;    // Percent of the block duration this instance may spend, 0 disables the governor
+    AkUInt32 uDiffuserType; // DIFFUSER_HADAMARD or DIFFUSER_VELVET
+    bool bCoalesce;         // Share one reverb engine between instances with identical parameters
+    AkUInt32 uBudgetScope;  // BUDGET_SCOPE_INSTANCE or BUDGET_SCOPE_GLOBAL
+};
+
+// One consistent copy of the parameter values, plus the parameters changed since the previous snapshot
+struct ReverbLabParamSnapshot
+{
+    ReverbLabRTPCParams RTPC;
+    ReverbLabNonRTPCParams NonRTPC;
+    AkUInt32 uChangeMask;
+
+    bool HasChanged(AkPluginParamID in_paramID) const { return (uChangeMask & (1u << in_paramID)) != 0; }
 };
 
 struct ReverbLabFXParams
@@ -78,10 +106,35 @@ struct ReverbLabFXParams
     /// Update a single parameter at a time and perform the necessary actions on the parameter changes.
     AKRESULT SetParam(AkPluginParamID in_paramID, const void* in_pValue, AkUInt32 in_ulParamSize) override;
 
-    AK::AkFXParameterChangeHandler<NUM_PARAMS> m_paramChangeHandler;
+    /// Copy the latest published parameters and consume the pending change flags.
+    /// Lock-free and wait-free, meant to be called once per block by the effect.
+    void AcquireSnapshot(ReverbLabParamSnapshot& out_rSnapshot);
 
+    /// Derived DSP state baked into the bank for this sample rate, or nullptr if there is none.
+    /// Only changes with SetParamsBlock, so read it from the effect's Init.
+    const ReverbLabBakedData* GetBakedData(AkUInt32 in_uSampleRate) const;
+
+    // Writer-side values. Only SetParam / SetParamsBlock touch these, Execute reads snapshots.
     ReverbLabRTPCParams RTPC;
     ReverbLabNonRTPCParams NonRTPC;
+
+private:
+    // Copy RTPC and NonRTPC into the back buffer, swap it in as the latest and flag the changed parameters
+    void PublishParams(AkUInt32 in_uChangeMask);
+
+    // Triple buffer: the writer owns one slot, the reader owns one, the middle one is exchanged.
+    // The middle index carries SNAPSHOT_NEW_BIT when it holds values the reader hasn't seen.
+    static const AkUInt32 SNAPSHOT_NEW_BIT = 0x4;
+    static const AkUInt32 SNAPSHOT_ALL_CHANGES = (1u << NUM_PARAMS) - 1;
+
+    ReverbLabBakedData m_bakedData;
+    bool m_bHasBakedData;
+
+    ReverbLabParamSnapshot m_snapshots[3];
+    AkUInt32 m_uWriteIndex;
+    AkUInt32 m_uReadIndex;
+    std::atomic<AkUInt32> m_uMiddleIndex;
+    std::atomic<AkUInt32> m_uChangeMask;
 };
 
 #endif // ReverbLabFXParams_H
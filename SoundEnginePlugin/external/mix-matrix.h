@@ -1,3 +1,5 @@
+#pragma once
+
 #include <cmath>
 
 // Use like `Householder<double, 8>::inPlace(data)` - size must be ≥ 1
@@ -1,20 +1,46 @@
+#pragma once
+
 #include "./delay.h"
 #include "./mix-matrix.h"
 
 #include "../../JuceModules/JuceHeader.h"
 
-#include <cstdlib>
-
-float randomInRange(float low, float high) {
-	float unitRand = rand() / float(RAND_MAX);
-	return low + unitRand * (high - low);
-}
+#include <algorithm>
 
 // This is a simple delay class which rounds to a whole number of samples.
 using Delay = signalsmith::delay::Delay<float, signalsmith::delay::InterpolatorNearest>;
 using Spec = juce::dsp::ProcessSpec;
 using IIRF = juce::dsp::IIR::Filter<float>;
 
+// Delay with an O(1) reset. Instead of clearing the buffer, count the samples written since the
+// last reset and read anything older as zero; the stale memory gets overwritten by normal writes.
+struct LazyResetDelay {
+	Delay delay;
+	int written = 0;
+	int maxDelay = 0;
+
+	void resize(int maxDelaySamples) {
+		maxDelay = maxDelaySamples;
+		delay.resize(maxDelaySamples + 1);
+		delay.reset();
+		written = maxDelay + 1;
+	}
+
+	void reset() {
+		written = 0;
+	}
+
+	float read(int delaySamples) const {
+		return delaySamples < written ? delay.read(delaySamples) : 0.f;
+	}
+
+	void write(float value) {
+		delay.write(value);
+		// Stop counting once the whole readable range holds fresh data
+		if (written <= maxDelay) ++written;
+	}
+};
+
 template<int channels = 8>
 struct MultiChannelMixedFeedback {
 	using Array = std::array<float, channels>;
@@ -22,19 +48,20 @@ struct MultiChannelMixedFeedback {
 	float decayGain = 0.85;
 
 	std::array<int, channels> delaySamples;
-	std::array<Delay, channels> delays;
+	std::array<LazyResetDelay, channels> delays;
 
-	void configure(float sampleRate) {
-		float delaySamplesBase = delayMs * 0.001 * sampleRate;
+	// Delay layout precomputed from delayMs, see ReverbLabComputeBakedData
+	void configure(const std::array<int, channels>& samples) {
 		for (int c = 0; c < channels; ++c) {
-			// Distribute delay times exponentially between delayMs and 2*delayMs
-			float r = c * 1.0 / channels;
-			delaySamples[c] = std::pow(2, r) * delaySamplesBase;
+			delaySamples[c] = samples[c];
 			delays[c].resize(delaySamples[c] + 1);
-			delays[c].reset();
 		}
 	}
 
+	void reset() {
+		for (auto& delay : delays) delay.reset();
+	}
+
 	Array process(Array input) {
 		Array delayed;
 		for (int c = 0; c < channels; ++c) {
@@ -60,30 +87,32 @@ struct DiffusionStep {
 	float delayMsRange = 50;
 
 	std::array<int, channels> delaySamples;
-	std::array<Delay, channels> delays;
+	std::array<LazyResetDelay, channels> delays;
 	std::array<bool, channels> flipPolarity;
 
-	void configure(float sampleRate) {
-		float delaySamplesRange = delayMsRange * 0.001 * sampleRate;
+	// Precomputed delays within delayMsRange; bit c of polarityMask flips channel c
+	void configure(const std::array<int, channels>& samples, unsigned polarityMask) {
 		for (int c = 0; c < channels; ++c) {
-			float rangeLow = delaySamplesRange * c / channels;
-			float rangeHigh = delaySamplesRange * (c + 1) / channels;
-			delaySamples[c] = randomInRange(rangeLow, rangeHigh);
+			delaySamples[c] = samples[c];
 			delays[c].resize(delaySamples[c] + 1);
-			delays[c].reset();
-			flipPolarity[c] = rand() % 2;
+			flipPolarity[c] = (polarityMask >> c) & 1;
 		}
 	}
 
+	void reset() {
+		for (auto& delay : delays) delay.reset();
+	}
+
 	// Decorrelate each channel's signal as much as possible for natural sounding
-	Array process(Array input, IIRF& dampingFilter, bool enableDamping) {
+	// dampingMix blends between the undamped (0) and damped (1) signal
+	Array process(Array input, IIRF& dampingFilter, float dampingMix) {
 		// Delay
 		Array delayed;
 		for (int c = 0; c < channels; ++c) {
 			delays[c].write(input[c]);
 			delayed[c] = delays[c].read(delaySamples[c]);
-			if (enableDamping) 
-				delayed[c] = dampingFilter.processSample(delayed[c]);
+			if (dampingMix > 0.f) 
+				delayed[c] += dampingMix * (dampingFilter.processSample(delayed[c]) - delayed[c]);
 		}
 
 		// Mix with a Hadamard matrix
@@ -113,8 +142,8 @@ struct DiffuserEqualLengths {
 		}
 	}
 
-	void configure(float sampleRate) {
-		for (auto& step : steps) step.configure(sampleRate);
+	void reset() {
+		for (auto& step : steps) step.reset();
 	}
 
 	Array process(Array samples) {
@@ -132,12 +161,29 @@ struct DiffuserHalfLengths {
 	using Step = DiffusionStep<channels>;
 	std::array<Step, stepCount> steps;
 
+	// Steps past activeSteps are crossfaded out and then skipped entirely
+	int activeSteps = stepCount;
+	std::array<float, stepCount> stepMix;
+	float fadeIncrement = 1.f;
+	float fadeMs = 50;
+
 	DiffuserHalfLengths(float diffusionMs) {
 		stepDelayUpadate(diffusionMs);
+		stepMix.fill(1.f);
 	}
 
-	void configure(float sampleRate) {
-		for (auto& step : steps) step.configure(sampleRate);
+	void configure(float sampleRate, const std::array<std::array<int, channels>, stepCount>& samples,
+		const std::array<unsigned, stepCount>& polarityMasks) {
+		for (int s = 0; s < stepCount; ++s) steps[s].configure(samples[s], polarityMasks[s]);
+		fadeIncrement = 1.f / (fadeMs * 0.001f * sampleRate);
+	}
+
+	void setActiveSteps(int count) {
+		activeSteps = std::max(1, std::min(count, stepCount));
+	}
+
+	void reset() {
+		for (auto& step : steps) step.reset();
 	}
 
 	void stepDelayUpadate(float diffusionMs) {
@@ -150,15 +196,134 @@ struct DiffuserHalfLengths {
 		}
 	}
 
-	Array process(Array samples, IIRF& dampingFilter, bool enableDamping) {
-		for (auto& step : steps) {
-			samples = step.process(samples, dampingFilter, enableDamping);
+	Array process(Array samples, IIRF& dampingFilter, float dampingMix) {
+		for (int s = 0; s < stepCount; ++s) {
+			float target = s < activeSteps ? 1.f : 0.f;
+			float& mix = stepMix[s];
+			if (mix == 0.f) {
+				// Bypassed step costs nothing. Clear its stale delay memory before fading back in.
+				if (target == 0.f) continue;
+				steps[s].reset();
+			}
+
+			Array diffused = steps[s].process(samples, dampingFilter, dampingMix);
+			if (mix != target) {
+				mix = target > mix ? std::min(mix + fadeIncrement, 1.f) : std::max(mix - fadeIncrement, 0.f);
+			}
+
+			if (mix == 1.f) {
+				samples = diffused;
+			}
+			else {
+				for (int c = 0; c < channels; ++c) {
+					samples[c] = mix * diffused[c] + (1.f - mix) * samples[c];
+				}
+			}
+		}
+		return samples;
+	}
+};
+
+// Sparse alternative to DiffuserHalfLengths: a cascade of velvet-noise stages. Each stage convolves
+// every channel with a handful of +/-1 taps, one at a random spot in each slice of the stage's time
+// span, then mixes the channels with a Hadamard matrix. Spans halve every stage like DiffuserHalfLengths;
+// echo density multiplies through the cascade, so a few taps per stage match the Hadamard steps.
+template<int channels = 8, int stageCount = 3, int tapsPerChannel = 4>
+struct VelvetDiffuser {
+	using Array = std::array<float, channels>;
+
+	struct Tap {
+		int delaySamples;
+		bool negative;
+	};
+
+	struct Stage {
+		std::array<std::array<Tap, tapsPerChannel>, channels> taps;
+		// Frame-major ring buffer of the stage input, so every tap is a single indexed load
+		std::vector<Array> history;
+		unsigned historyMask = 0;
+	};
+
+	std::array<Stage, stageCount> stages;
+	// Keeps the energy of the sum of taps equal to the input
+	float tapGain = 1.f / std::sqrt(float(tapsPerChannel));
+
+	// All stages write one frame per process(), so they share the write position
+	unsigned writeIndex = 0;
+	int maxDelay = 0;
+	// Frames written since reset(); older frames read as zero (same idea as LazyResetDelay)
+	int written = 0;
+
+	// Use precomputed taps (see ReverbLabComputeBakedData); bit k of signMasks[s][c] makes tap k negative
+	void configure(const std::array<std::array<std::array<int, tapsPerChannel>, channels>, stageCount>& delays,
+		const std::array<std::array<unsigned, channels>, stageCount>& signMasks) {
+		maxDelay = 0;
+		for (int s = 0; s < stageCount; ++s) {
+			Stage& stage = stages[s];
+			int stageMaxDelay = 0;
+			for (int c = 0; c < channels; ++c) {
+				for (int k = 0; k < tapsPerChannel; ++k) {
+					Tap& tap = stage.taps[c][k];
+					tap.delaySamples = delays[s][c][k];
+					tap.negative = (signMasks[s][c] >> k) & 1;
+					stageMaxDelay = std::max(stageMaxDelay, tap.delaySamples);
+				}
+			}
+
+			int historyLength = 1;
+			while (historyLength < stageMaxDelay + 1) historyLength *= 2;
+			stage.history.assign(historyLength, Array{});
+			stage.historyMask = unsigned(historyLength - 1);
+			maxDelay = std::max(maxDelay, stageMaxDelay);
+		}
+		writeIndex = 0;
+		written = maxDelay + 1;
+	}
+
+	void reset() {
+		written = 0;
+	}
+
+	Array process(Array samples, IIRF& dampingFilter, float dampingMix) {
+		++writeIndex;
+		bool warmingUp = written <= maxDelay;
+		if (warmingUp) ++written;
+
+		for (Stage& stage : stages) {
+			stage.history[writeIndex & stage.historyMask] = samples;
+
+			// Sparse convolution: only additions and subtractions per tap
+			for (int c = 0; c < channels; ++c) {
+				float sum = warmingUp ? sumTaps<true>(stage, c) : sumTaps<false>(stage, c);
+				samples[c] = sum * tapGain;
+			}
+
+			// Mix with a Hadamard matrix
+			Hadamard<float, channels>::inPlace(samples.data());
+		}
+
+		if (dampingMix > 0.f) {
+			for (int c = 0; c < channels; ++c)
+				samples[c] += dampingMix * (dampingFilter.processSample(samples[c]) - samples[c]);
 		}
 		return samples;
 	}
+
+private:
+	// The warm-up check stays out of the steady-state loop
+	template<bool warmingUp>
+	float sumTaps(const Stage& stage, int c) const {
+		float sum = 0;
+		for (const Tap& tap : stage.taps[c]) {
+			if (warmingUp && tap.delaySamples >= written) continue;
+			float sample = stage.history[(writeIndex - unsigned(tap.delaySamples)) & stage.historyMask][c];
+			sum += tap.negative ? -sample : sample;
+		}
+		return sum;
+	}
 };
 
-template<int channels = 8, int diffusionSteps = 5>
+template<int channels = 8, int diffusionSteps = 5, int velvetStages = 3, int velvetTaps = 4>
 struct BasicReverb {
 	// Holding 8 channels' current sample
 	using Array = std::array<float, channels>;
@@ -166,30 +331,68 @@ struct BasicReverb {
 	Spec reverbSpec;
 	MultiChannelMixedFeedback<channels> feedback;
 	DiffuserHalfLengths<channels, diffusionSteps> diffuser;
+	VelvetDiffuser<channels, velvetStages, velvetTaps> velvetDiffuser;
+	bool useVelvetDiffuser = false;
 	juce::dsp::IIR::Filter<float> highShelfFilter;
 	bool enableDamping = false;
+	// Damping is crossfaded in and out rather than switched, like the diffusion steps
+	float dampingMix = 0.f;
+	float dampingFadeIncrement = 1.f;
+	float dampingFadeMs = 50;
+
+	// Quality tiers, from full quality (0) to cheapest: damping off, then fewer diffusion steps.
+	// The velvet diffuser is already cheap, only the damping tier affects it (see maxQualityTier)
+	static constexpr int qualityTiers = 4;
+	int qualityTier = 0;
 
 	float rt60, roomSizeMs, sampleRate;
 
 	// Constructor
 	BasicReverb(float roomSizeMs, float rt60) 
-		: diffuser(roomSizeMs),roomSizeMs(roomSizeMs) {
+		: diffuser(roomSizeMs), roomSizeMs(roomSizeMs) {
 		feedback.delayMs = roomSizeMs;
 		setRt60(rt60);
 	}
 
-	void configure(const Spec& spec) {
-		// Setup BasicReverb when Init()
+	// Setup BasicReverb when Init(), with a precomputed delay layout (see ReverbLabComputeBakedData).
+	// Damping needs setDamping or setDampingCoefficients afterwards.
+	void configure(const Spec& spec, const std::array<int, channels>& feedbackDelays,
+		const std::array<std::array<int, channels>, diffusionSteps>& diffusionDelays,
+		const std::array<unsigned, diffusionSteps>& polarityMasks,
+		const std::array<std::array<std::array<int, velvetTaps>, channels>, velvetStages>& velvetDelays,
+		const std::array<std::array<unsigned, channels>, velvetStages>& velvetSignMasks) {
 		reverbSpec = spec;
-		feedback.configure(reverbSpec.sampleRate);
-		diffuser.configure(reverbSpec.sampleRate);
+		feedback.configure(feedbackDelays);
+		diffuser.configure(reverbSpec.sampleRate, diffusionDelays, polarityMasks);
 		setupFilter();
+		dampingFadeIncrement = 1.f / (dampingFadeMs * 0.001f * spec.sampleRate);
 		this->sampleRate = spec.sampleRate;
+		// Both diffusers are always set up, so switching between them never allocates
+		velvetDiffuser.configure(velvetDelays, velvetSignMasks);
+	}
+
+	// Silence the reverb tail in constant time; delay memory is cleared lazily by later writes
+	void reset() {
+		diffuser.reset();
+		velvetDiffuser.reset();
+		feedback.reset();
+		highShelfFilter.reset();
+		// Nothing to fade against
+		dampingMix = dampingTarget();
 	}
 
 	Array process(Array input) {
+		float target = dampingTarget();
+		if (dampingMix != target) {
+			// Fully off, the filter kept its state from before: clear it before fading back in
+			if (dampingMix == 0.f) highShelfFilter.reset();
+			dampingMix = target > dampingMix ? std::min(dampingMix + dampingFadeIncrement, 1.f)
+				: std::max(dampingMix - dampingFadeIncrement, 0.f);
+		}
+
 		// Do diffuse and feedback processing successively for input signals
-		Array diffuse = diffuser.process(input, highShelfFilter, enableDamping);
+		Array diffuse = useVelvetDiffuser ? velvetDiffuser.process(input, highShelfFilter, dampingMix)
+			: diffuser.process(input, highShelfFilter, dampingMix);
 		Array longLasting = feedback.process(diffuse);
 		Array output;
 		for (int c = 0; c < channels; ++c) {
@@ -199,12 +402,9 @@ struct BasicReverb {
 	}
 
 	void setupFilter() {
-		// Setup filter with default values when Init()
+		// Coefficients are left to setDamping / setDampingCoefficients, so baked ones aren't computed twice
 		highShelfFilter.reset();
 		highShelfFilter.prepare(reverbSpec);
-		auto coefficients = juce::dsp::IIR::Coefficients<float>::makeHighShelf
-		(reverbSpec.sampleRate, 15000.f, 0.5f, juce::Decibels::decibelsToGain(0.f));
-		highShelfFilter.coefficients = coefficients;
 	}
 
 	void setRt60(float newRt60) {
@@ -225,14 +425,56 @@ struct BasicReverb {
 		if (cutoff > 14999.f) enableDamping = false;
 	}
 
+	// Precomputed equivalents of setRt60 / setDamping
+	void setDecayGain(float newRt60, float decayGain) {
+		rt60 = newRt60;
+		feedback.decayGain = decayGain;
+	}
+
+	void setDampingCoefficients(const std::array<float, 5>& coefficients, bool enable) {
+		// b0, b1, b2, a1, a2, already normalised
+		highShelfFilter.coefficients = new juce::dsp::IIR::Coefficients<float>(
+			coefficients[0], coefficients[1], coefficients[2], 1.f, coefficients[3], coefficients[4]);
+		highShelfFilter.reset();
+		enableDamping = enable;
+	}
+
 	void setGeometry(float geometry) {
 	}
 
+	// Switch between the Hadamard diffusion steps and the velvet-noise diffuser
+	void setVelvetDiffuser(bool enable) {
+		if (enable == useVelvetDiffuser) return;
+		// Whichever diffuser takes over starts from silence
+		if (enable) velvetDiffuser.reset();
+		else diffuser.reset();
+		useVelvetDiffuser = enable;
+		setQualityTier(qualityTier);
+	}
+
+	// Cheapest tier that still saves anything with the current diffuser
+	int maxQualityTier() const {
+		return useVelvetDiffuser ? 1 : qualityTiers - 1;
+	}
+
+	void setQualityTier(int tier) {
+		qualityTier = std::max(0, std::min(tier, maxQualityTier()));
+		// Shorter steps go first, they contribute least to the echo density
+		if (qualityTier <= 1) diffuser.setActiveSteps(diffusionSteps);
+		else if (qualityTier == 2) diffuser.setActiveSteps(diffusionSteps - (diffusionSteps - 1) / 2);
+		else diffuser.setActiveSteps(1);
+	}
+
 	void filterSnapToZero() {
 		highShelfFilter.snapToZero();
 	}
 
 private:
+	// Damping is off when not needed and in the cheaper quality tiers
+	float dampingTarget() const {
+		return enableDamping && qualityTier == 0 ? 1.f : 0.f;
+	}
+
 	void updateDecayGain() {
 		// How long does our signal take to go around the feedback loop?
 		float typicalLoopMs = roomSizeMs * 1.5;
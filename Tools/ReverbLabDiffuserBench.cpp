@@ -0,0 +1,153 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2023 Audiokinetic Inc.
+*******************************************************************************/
+
+// Compares the velvet-noise diffuser with the Hadamard diffusion steps: echo density of the impulse
+// response, and cost per frame for the diffuser alone and for the whole network. Fails if the velvet
+// diffuser falls below half the echo density of the Hadamard steps. Timings are only reported.
+
+#include "ReverbLabToolsCommon.h"
+
+#include <AK/Tools/Common/AkPlatformFuncs.h>
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+
+using Array = std::array<float, CHANNELS>;
+
+// Echoes are counted over this much of the impulse response
+static const AkUInt32 DENSITY_FRAMES = SAMPLE_RATE / 20;
+static const AkUInt32 TIMING_FRAMES = SAMPLE_RATE * 5;
+static const AkUInt32 TIMING_RUNS = 5;
+static const AkReal32 MIN_DENSITY_RATIO = 0.5f;
+
+struct Density
+{
+    AkUInt32 uOneChannel;   // impulse on channel 0
+    AkUInt32 uAllChannels;  // impulse on every channel
+};
+
+// Nonzero output samples over all channels, for an impulse on one channel and on all of them
+template<class Process>
+static Density MeasureDensity(Process in_process)
+{
+    Density density = {};
+    for (int iMode = 0; iMode < 2; ++iMode)
+    {
+        AkUInt32 uEchoes = 0;
+        Array input = {};
+        if (iMode == 0)
+            input[0] = 1.f;
+        else
+            input.fill(1.f);
+        for (AkUInt32 i = 0; i < DENSITY_FRAMES; ++i)
+        {
+            Array output = in_process(input, i == 0);
+            input.fill(0.f);
+            for (float sample : output)
+            {
+                if (std::fabs(sample) > 1e-9f)
+                    ++uEchoes;
+            }
+        }
+        (iMode == 0 ? density.uOneChannel : density.uAllChannels) = uEchoes;
+    }
+    return density;
+}
+
+// Best of TIMING_RUNS, in nanoseconds per frame
+template<class Process>
+static AkReal64 MeasureCost(Process in_process, AkReal32& io_fSink)
+{
+    AkInt64 iTicksPerSecond = 0;
+    AKPLATFORM::PerformanceFrequency(&iTicksPerSecond);
+
+    AkReal64 fBest = 1e30;
+    AkUInt32 uNoiseState = 1;
+    Array input = {};
+    for (AkUInt32 uRun = 0; uRun < TIMING_RUNS; ++uRun)
+    {
+        AkInt64 iStart = 0, iEnd = 0;
+        AKPLATFORM::PerformanceCounter(&iStart);
+        for (AkUInt32 i = 0; i < TIMING_FRAMES; ++i)
+        {
+            uNoiseState = uNoiseState * 1664525u + 1013904223u;
+            input[i % CHANNELS] = (uNoiseState >> 8) * (1.f / 16777216.f) - 0.5f;
+            io_fSink += in_process(input, false)[0];
+        }
+        AKPLATFORM::PerformanceCounter(&iEnd);
+        AkReal64 fNanoseconds = 1e9 * (AkReal64)(iEnd - iStart) / (AkReal64)iTicksPerSecond / TIMING_FRAMES;
+        fBest = fNanoseconds < fBest ? fNanoseconds : fBest;
+    }
+    return fBest;
+}
+
+int main()
+{
+    ReverbLabReverb reverb(ROOM_SIZE, 2.f);
+    ReverbLabSetUpReverb(reverb, 512);
+
+    // Diffusers on their own, undamped, so only the diffusion itself is compared
+    IIRF unusedFilter;
+    auto hadamard = [&](const Array& in_input, bool in_bReset)
+    {
+        if (in_bReset) reverb.diffuser.reset();
+        return reverb.diffuser.process(in_input, unusedFilter, 0.f);
+    };
+    auto velvet = [&](const Array& in_input, bool in_bReset)
+    {
+        if (in_bReset) reverb.velvetDiffuser.reset();
+        return reverb.velvetDiffuser.process(in_input, unusedFilter, 0.f);
+    };
+    auto network = [&](const Array& in_input, bool)
+    {
+        return reverb.process(in_input);
+    };
+
+    AkReal32 fSink = 0.f;
+    const Density hadamardDensity = MeasureDensity(hadamard);
+    const Density velvetDensity = MeasureDensity(velvet);
+    const AkReal64 fHadamardCost = MeasureCost(hadamard, fSink);
+    const AkReal64 fVelvetCost = MeasureCost(velvet, fSink);
+
+    reverb.setVelvetDiffuser(false);
+    const AkReal64 fHadamardNetworkCost = MeasureCost(network, fSink);
+    reverb.setVelvetDiffuser(true);
+    const AkReal64 fVelvetNetworkCost = MeasureCost(network, fSink);
+
+    printf("echoes in %u ms     one channel  all channels  diffuser ns/frame  network ns/frame\n", DENSITY_FRAMES * 1000 / SAMPLE_RATE);
+    printf("hadamard x%d        %11u  %12u  %17.1f  %16.1f\n", DIFFUSER_STEPS,
+        hadamardDensity.uOneChannel, hadamardDensity.uAllChannels, fHadamardCost, fHadamardNetworkCost);
+    printf("velvet             %11u  %12u  %17.1f  %16.1f\n",
+        velvetDensity.uOneChannel, velvetDensity.uAllChannels, fVelvetCost, fVelvetNetworkCost);
+
+    bool bPassed = velvetDensity.uOneChannel >= MIN_DENSITY_RATIO * hadamardDensity.uOneChannel
+        && velvetDensity.uAllChannels >= MIN_DENSITY_RATIO * hadamardDensity.uAllChannels;
+    if (!bPassed)
+        printf("FAIL: velvet echo density below %.0f%% of the Hadamard steps\n", 100.f * MIN_DENSITY_RATIO);
+
+    return ReverbLabReportResult(bPassed, fSink);
+}
@@ -0,0 +1,257 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2023 Audiokinetic Inc.
+*******************************************************************************/
+
+// Headless stress test for ReverbLabFXGovernor. Runs the reverb network block by block with a
+// synthetic extra load standing in for the rest of the frame, and checks that the governor brings
+// the measured load under the budget, then restores full quality once the extra load goes away.
+// Then checks the same with a global budget when voices are added, each costing no more than before.
+// Blocks run back to back, not in real time; load is in percent of each block's real-time duration.
+
+#include "ReverbLabToolsCommon.h"
+#include "ReverbLabFXGovernor.h"
+
+#include <AK/Tools/Common/AkPlatformFuncs.h>
+
+#include <array>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+static const AkUInt32 BLOCK_FRAMES = 512;
+
+static const AkUInt32 CALIBRATION_BLOCKS = 200;
+static const AkUInt32 PRESSURE_BLOCKS = 1500;
+// The load has to hold under budget over this many blocks at the end of the pressure phase
+static const AkUInt32 SETTLED_BLOCKS = 500;
+static const AkUInt32 MAX_RECOVERY_BLOCKS = 2000;
+// Averaged load may exceed the budget by this much before the test fails (timer noise)
+static const AkReal32 BUDGET_TOLERANCE = 1.1f;
+// Voices in the global budget scene, and frames with a single voice before they are added
+static const AkUInt32 GLOBAL_VOICES = 4;
+static const AkUInt32 SINGLE_VOICE_BLOCKS = 300;
+
+static AkInt64 s_iTicksPerSecond = 0;
+
+static AkReal64 SecondsSince(AkInt64 in_iStart)
+{
+    AkInt64 iNow = 0;
+    AKPLATFORM::PerformanceCounter(&iNow);
+    return (AkReal64)(iNow - in_iStart) / (AkReal64)s_iTicksPerSecond;
+}
+
+static AkReal64 BlockSeconds()
+{
+    return (AkReal64)BLOCK_FRAMES / (AkReal64)SAMPLE_RATE;
+}
+
+// One block of reverb on noise, then busy-wait until in_fExtraLoad percent of the block duration has
+// passed on top of it
+static void RunBlock(ReverbLabReverb& io_rReverb, AkUInt32& io_uNoiseState, AkReal32 in_fExtraLoad, AkReal32& io_fSink)
+{
+    AkInt64 iStart = 0;
+    AKPLATFORM::PerformanceCounter(&iStart);
+
+    std::array<float, CHANNELS> input;
+    for (AkUInt32 i = 0; i < BLOCK_FRAMES; ++i)
+    {
+        for (float& sample : input)
+        {
+            io_uNoiseState = io_uNoiseState * 1664525u + 1013904223u;
+            sample = (io_uNoiseState >> 8) * (1.f / 16777216.f) - 0.5f;
+        }
+        io_fSink += io_rReverb.process(input)[0];
+    }
+
+    AkInt64 iSpinStart = 0;
+    AKPLATFORM::PerformanceCounter(&iSpinStart);
+    const AkReal64 fSpinSeconds = in_fExtraLoad * 0.01 * BlockSeconds();
+    while (SecondsSince(iSpinStart) < fSpinSeconds)
+    {
+    }
+}
+
+int main()
+{
+    AKPLATFORM::PerformanceFrequency(&s_iTicksPerSecond);
+
+    ReverbLabReverb reverb(ROOM_SIZE, 2.f);
+    ReverbLabSetUpReverb(reverb, BLOCK_FRAMES);
+
+    AkUInt32 uNoiseState = 1;
+    AkReal32 fSink = 0.f;
+
+    // What each tier costs on this machine
+    std::array<AkReal32, ReverbLabReverb::qualityTiers> tierLoads;
+    for (int iTier = 0; iTier < ReverbLabReverb::qualityTiers; ++iTier)
+    {
+        reverb.setQualityTier(iTier);
+        AkInt64 iStart = 0;
+        AKPLATFORM::PerformanceCounter(&iStart);
+        for (AkUInt32 uBlock = 0; uBlock < CALIBRATION_BLOCKS; ++uBlock)
+            RunBlock(reverb, uNoiseState, 0.f, fSink);
+        tierLoads[iTier] = (AkReal32)(100. * SecondsSince(iStart) / (CALIBRATION_BLOCKS * BlockSeconds()));
+        printf("tier %d: %.3f%% load\n", iTier, tierLoads[iTier]);
+    }
+
+    const AkReal32 fFullLoad = tierLoads[0];
+    const AkReal32 fCheapestLoad = tierLoads[ReverbLabReverb::qualityTiers - 1];
+    if (fFullLoad < fCheapestLoad * 1.2f)
+    {
+        printf("FAIL: tiers too close in cost to test the governor\n");
+        return 1;
+    }
+
+    // The extra load dominates, so the headroom band is reached once it goes away. The budget sits
+    // halfway between full quality and the cheapest tier on top of it, so the governor has to step down.
+    const AkReal32 fExtraLoad = 4.f * fFullLoad;
+    const AkReal32 fBudget = fExtraLoad + 0.5f * (fFullLoad + fCheapestLoad);
+
+    ReverbLabFXGovernor governor;
+    governor.Init(ReverbLabReverb::qualityTiers - 1);
+    governor.SetBudget(fBudget, false);
+    reverb.setQualityTier(0);
+
+    AkUInt32 uBufferTick = 0;
+    auto runGoverned = [&](AkReal32 in_fExtraLoad)
+    {
+        governor.BeginBlock();
+        RunBlock(reverb, uNoiseState, in_fExtraLoad, fSink);
+        AkUInt32 uTier = governor.EndBlock(BLOCK_FRAMES, SAMPLE_RATE, ++uBufferTick);
+        if ((int)uTier != reverb.qualityTier)
+            reverb.setQualityTier(uTier);
+    };
+
+    // Under pressure: full quality is over budget
+    AkReal64 fSettledLoad = 0.;
+    for (AkUInt32 uBlock = 0; uBlock < PRESSURE_BLOCKS; ++uBlock)
+    {
+        runGoverned(fExtraLoad);
+        if (uBlock >= PRESSURE_BLOCKS - SETTLED_BLOCKS)
+            fSettledLoad += governor.GetAverageLoad();
+    }
+    fSettledLoad /= SETTLED_BLOCKS;
+    const AkUInt32 uPressureTier = governor.GetTier();
+    printf("budget %.3f%%: settled at tier %u, average load %.3f%%\n", fBudget, uPressureTier, fSettledLoad);
+
+    // Headroom again: quality has to come back
+    AkUInt32 uRecoveryBlocks = 0;
+    while (governor.GetTier() > 0 && uRecoveryBlocks < MAX_RECOVERY_BLOCKS)
+    {
+        runGoverned(0.f);
+        ++uRecoveryBlocks;
+    }
+    printf("without extra load: tier %u after %u blocks\n", governor.GetTier(), uRecoveryBlocks);
+
+    bool bPassed = true;
+    if (uPressureTier == 0)
+    {
+        printf("FAIL: governor never stepped down\n");
+        bPassed = false;
+    }
+    if (fSettledLoad > fBudget * BUDGET_TOLERANCE)
+    {
+        printf("FAIL: load not held under the budget\n");
+        bPassed = false;
+    }
+    if (governor.GetTier() != 0)
+    {
+        printf("FAIL: quality did not recover\n");
+        bPassed = false;
+    }
+
+    // Global budget: one voice fits at full quality, GLOBAL_VOICES don't. Each voice alone stays far
+    // under the budget, so only their sum can make the governors step down.
+    const AkReal32 fGlobalBudget = 0.5f * GLOBAL_VOICES * (fFullLoad + fCheapestLoad);
+    std::vector<std::unique_ptr<ReverbLabReverb>> voices;
+    std::vector<ReverbLabFXGovernor> governors(GLOBAL_VOICES);
+    for (AkUInt32 uVoice = 0; uVoice < GLOBAL_VOICES; ++uVoice)
+    {
+        voices.push_back(std::make_unique<ReverbLabReverb>(ROOM_SIZE, 2.f));
+        ReverbLabSetUpReverb(*voices.back(), BLOCK_FRAMES);
+        governors[uVoice].Init(ReverbLabReverb::qualityTiers - 1);
+        governors[uVoice].SetBudget(fGlobalBudget, true);
+    }
+
+    auto runGlobalFrame = [&](AkUInt32 in_uVoices)
+    {
+        ++uBufferTick;
+        for (AkUInt32 uVoice = 0; uVoice < in_uVoices; ++uVoice)
+        {
+            governors[uVoice].BeginBlock();
+            RunBlock(*voices[uVoice], uNoiseState, 0.f, fSink);
+            AkUInt32 uTier = governors[uVoice].EndBlock(BLOCK_FRAMES, SAMPLE_RATE, uBufferTick);
+            if ((int)uTier != voices[uVoice]->qualityTier)
+                voices[uVoice]->setQualityTier(uTier);
+        }
+    };
+
+    for (AkUInt32 uBlock = 0; uBlock < SINGLE_VOICE_BLOCKS; ++uBlock)
+        runGlobalFrame(1);
+    const AkUInt32 uSingleVoiceTier = governors[0].GetTier();
+
+    AkReal64 fSettledGlobalLoad = 0.;
+    for (AkUInt32 uBlock = 0; uBlock < PRESSURE_BLOCKS; ++uBlock)
+    {
+        runGlobalFrame(GLOBAL_VOICES);
+        if (uBlock >= PRESSURE_BLOCKS - SETTLED_BLOCKS)
+            fSettledGlobalLoad += governors[0].GetAverageLoad();
+    }
+    fSettledGlobalLoad /= SETTLED_BLOCKS;
+    const AkUInt32 uGlobalPressureTier = governors[0].GetTier();
+    printf("global budget %.3f%%: 1 voice at tier %u, %u voices settled at tier %u, total load %.3f%%\n",
+        fGlobalBudget, uSingleVoiceTier, GLOBAL_VOICES, uGlobalPressureTier, fSettledGlobalLoad);
+
+    AkUInt32 uGlobalRecoveryBlocks = 0;
+    while (governors[0].GetTier() > 0 && uGlobalRecoveryBlocks < MAX_RECOVERY_BLOCKS)
+    {
+        runGlobalFrame(1);
+        ++uGlobalRecoveryBlocks;
+    }
+    printf("back to 1 voice: tier %u after %u blocks\n", governors[0].GetTier(), uGlobalRecoveryBlocks);
+
+    if (uSingleVoiceTier != 0)
+    {
+        printf("FAIL: a single voice under the global budget was degraded\n");
+        bPassed = false;
+    }
+    if (uGlobalPressureTier == 0)
+    {
+        printf("FAIL: adding voices never stepped the global budget down\n");
+        bPassed = false;
+    }
+    if (fSettledGlobalLoad > fGlobalBudget * BUDGET_TOLERANCE)
+    {
+        printf("FAIL: total load not held under the global budget\n");
+        bPassed = false;
+    }
+    if (governors[0].GetTier() != 0)
+    {
+        printf("FAIL: quality did not recover under the global budget\n");
+        bPassed = false;
+    }
+
+    return ReverbLabReportResult(bPassed, fSink);
+}
@@ -0,0 +1,63 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2023 Audiokinetic Inc.
+*******************************************************************************/
+
+// Setup shared by the headless tools
+
+#ifndef ReverbLabToolsCommon_H
+#define ReverbLabToolsCommon_H
+
+#include "ReverbLabFXReverb.h"
+
+#include <cstdio>
+
+static const AkUInt32 SAMPLE_RATE = 48000;
+
+/// Configure io_rReverb from baked data, the way ReverbLabFX does when the bank carries it:
+/// 2 s decay, damping at 5 kHz by 6 dB, at SAMPLE_RATE.
+inline void ReverbLabSetUpReverb(ReverbLabReverb& io_rReverb, AkUInt32 in_uMaxBlockSize)
+{
+    ReverbLabBakedData data;
+    ReverbLabComputeBakedData(2.f, 5000.f, 6.f, 0.f, SAMPLE_RATE, data);
+
+    juce::dsp::ProcessSpec spec;
+    spec.sampleRate = SAMPLE_RATE;
+    spec.maximumBlockSize = in_uMaxBlockSize;
+    spec.numChannels = 1;
+
+    io_rReverb.configure(spec, data.feedbackDelays, data.diffusionDelays, data.polarityMasks, data.velvetDelays, data.velvetSignMasks);
+    io_rReverb.setDecayGain(data.fRT, data.fDecayGain);
+    io_rReverb.setDampingCoefficients(data.shelfCoefficients, data.bEnableDamping);
+}
+
+/// Print the outcome and return the process exit code. in_fSink is what the tool accumulated
+/// from the reverb output: printing it keeps that work observable, so none of it is optimized away.
+inline int ReverbLabReportResult(bool in_bPassed, AkReal32 in_fSink)
+{
+    printf("%s (%g)\n", in_bPassed ? "PASSED" : "FAILED", in_fSink);
+    return in_bPassed ? 0 : 1;
+}
+
+#endif // ReverbLabToolsCommon_H
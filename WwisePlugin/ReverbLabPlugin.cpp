@@ -26,6 +26,7 @@ the specific language governing permissions and limitations under the License.
 
 #include "ReverbLabPlugin.h"
 #include "../SoundEnginePlugin/ReverbLabFXFactory.h"
+#include "../SoundEnginePlugin/ReverbLabFXBakedData.h"
 
 ReverbLabPlugin::ReverbLabPlugin()
 {
@@ -44,10 +45,55 @@ bool ReverbLabPlugin::GetBankParameters(const GUID & in_guidPlatform, AK::Wwise:
     in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "StereoWidth"));
     in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "DryWetMix"));
     in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "OutputGain"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "CPUBudget"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "DiffuserType"));
+    in_dataWriter.WriteInt32(m_propertySet.GetBool(in_guidPlatform, "Coalesce") ? 1 : 0);
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "BudgetScope"));
+
+    // Derived DSP state for the platform's sample rate, so the device doesn't have to compute it on load
+    const AkInt32 iBakeSampleRate = m_propertySet.GetInt32(in_guidPlatform, "BakeSampleRate");
+    if (iBakeSampleRate > 0)
+    {
+        ReverbLabBakedData bakedData;
+        ReverbLabComputeBakedData(
+            m_propertySet.GetReal32(in_guidPlatform, "RT"),
+            m_propertySet.GetReal32(in_guidPlatform, "HFCutoff"),
+            m_propertySet.GetReal32(in_guidPlatform, "HFAttenuation"),
+            m_propertySet.GetReal32(in_guidPlatform, "CPUBudget"),
+            (AkUInt32)iBakeSampleRate,
+            bakedData);
+        WriteBakedData(bakedData, in_dataWriter);
+    }
   
     return true;
 }
 
+void ReverbLabPlugin::WriteBakedData(const ReverbLabBakedData& in_rData, AK::Wwise::Plugin::DataWriter& in_dataWriter) const
+{
+    // Must match the read order in ReverbLabFXParams::SetParamsBlock
+    in_dataWriter.WriteInt32((AkInt32)REVERBLAB_BAKED_DATA_VERSION);
+    in_dataWriter.WriteInt32((AkInt32)in_rData.uSampleRate);
+    for (AkInt32 delay : in_rData.feedbackDelays)
+        in_dataWriter.WriteInt32(delay);
+    for (const auto& stepDelays : in_rData.diffusionDelays)
+        for (AkInt32 delay : stepDelays)
+            in_dataWriter.WriteInt32(delay);
+    for (AkUInt32 mask : in_rData.polarityMasks)
+        in_dataWriter.WriteInt32((AkInt32)mask);
+    for (const auto& stageDelays : in_rData.velvetDelays)
+        for (const auto& channelDelays : stageDelays)
+            for (AkInt32 delay : channelDelays)
+                in_dataWriter.WriteInt32(delay);
+    for (const auto& stageMasks : in_rData.velvetSignMasks)
+        for (AkUInt32 mask : stageMasks)
+            in_dataWriter.WriteInt32((AkInt32)mask);
+    in_dataWriter.WriteReal32(in_rData.fDecayGain);
+    for (AkReal32 coefficient : in_rData.shelfCoefficients)
+        in_dataWriter.WriteReal32(coefficient);
+    in_dataWriter.WriteInt32(in_rData.bEnableDamping ? 1 : 0);
+    in_dataWriter.WriteInt32((AkInt32)in_rData.uQualityTier);
+}
+
 DEFINE_AUDIOPLUGIN_CONTAINER(ReverbLab);											// Create a PluginContainer structure that contains the info for our plugin
 EXPORT_AUDIOPLUGIN_CONTAINER(ReverbLab);											// This is a DLL, we want to have a standardized name
 ADD_AUDIOPLUGIN_CLASS_TO_CONTAINER(                                             // Add our CLI class to the PluginContainer
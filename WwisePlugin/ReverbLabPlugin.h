@@ -28,6 +28,8 @@ the specific language governing permissions and limitations under the License.
 
 #include <AK/Wwise/Plugin.h>
 
+struct ReverbLabBakedData;
+
 /// See https://www.audiokinetic.com/library/edge/?source=SDK&id=plugin__dll.html
 /// for the documentation about Authoring plug-ins
 class ReverbLabPlugin final
@@ -41,6 +43,11 @@ public:
     /// Because these can be changed at run-time, the parameter block should stay relatively small.
     // Larger data should be put in the Data Block.
     bool GetBankParameters(const GUID & in_guidPlatform, AK::Wwise::Plugin::DataWriter& in_dataWriter) const override;
+
+private:
+    /// Versioned block of derived DSP state, appended after the parameters. It stays in the parameter
+    /// block rather than the Data Block because it is only valid for the parameter values sent with it.
+    void WriteBakedData(const ReverbLabBakedData& in_rData, AK::Wwise::Plugin::DataWriter& in_dataWriter) const;
 };
 
 DECLARE_AUDIOPLUGIN_CONTAINER(ReverbLab);	// Exposes our PluginContainer structure that contains the info for our plugin